@@ -16,12 +16,20 @@
 # under the License.
 
 from _datasketches import PyObjectSerDe
-
-import struct
-
-# This file provides several Python SerDe implementation examples.
+from _datasketches import PyStringsSerDe, PyIntsSerDe, PyLongsSerDe
+from _datasketches import PyFloatsSerDe, PyDoublesSerDe
+
+# The provided SerDes for str, int and float items are implemented in C++
+# so that sketches can serialize and deserialize their items without a
+# call into Python for each one. Their formats are:
+#   * PyStringsSerDe: a 4-byte little-endian byte count followed by the
+#     UTF-8 encoded string, with no null termination
+#   * PyIntsSerDe: struct format '<i'
+#   * PyLongsSerDe: struct format '<q'
+#   * PyFloatsSerDe: struct format '<f'
+#   * PyDoublesSerDe: struct format '<d'
 #
-# Each implementation must extend the PyObjectSerDe class and define
+# Custom implementations must extend the PyObjectSerDe class and define
 # three methods:
 #   * get_size(item) returns an int of the number of bytes needed to
 #     serialize the given item
@@ -31,80 +39,33 @@ import struct
 #     indicating where in the data array to start reading. The method
 #     returns a tuple with the newly reconstructed object and the
 #     total number of bytes beyond the offset read from the input data.
-
-class PyStringsSerDe(PyObjectSerDe):
-  '''Implements a simple string-encoding scheme where a string is
-     written as `<num_bytes> <string_contents>`, with no null termination.
-     This format allows pre-allocating each string, at the cost of
-     additional storage. Using this format, the serialized string consumes
-     ``4 + len(item)`` bytes.'''
-  def get_size(self, item):
-    return int(4 + len(item))
-
-  def to_bytes(self, item: str):
-    b = bytearray()
-    b.extend(len(item).to_bytes(4, 'little'))
-    b.extend(map(ord,item))
-    return bytes(b)
-
-  def from_bytes(self, data: bytes, offset: int):
-    num_chars = int.from_bytes(data[offset:offset+3], 'little')
-    if (num_chars < 0 or num_chars > offset + len(data)):
-        raise IndexError(f'num_chars read must be non-negative and not larger than the buffer. Found {num_chars}')
-    str = data[offset+4:offset+4+num_chars].decode()
-    return (str, 4+num_chars)
-
-class PyIntsSerDe(PyObjectSerDe):
-  '''Implements an integer encoding scheme where each integer is written
-     as a 32-bit (4 byte) little-endian value.'''
-  def get_size(self, item):
-    return int(4)
-
-  def to_bytes(self, item):
-    return struct.pack('<i', item)
-
-  def from_bytes(self, data: bytes, offset: int):
-    val = struct.unpack_from('<i', data, offset)[0]
-    return (val, 4)
-
-
-class PyLongsSerDe(PyObjectSerDe):
-  '''Implements an integer encoding scheme where each integer is written
-     as a 64-bit (8 byte) little-endian value.'''
-  def get_size(self, item):
-    return int(8)
-
-  def to_bytes(self, item):
-    return struct.pack('<q', item)
-
-  def from_bytes(self, data: bytes, offset: int):
-    val = struct.unpack_from('<q', data, offset)[0]
-    return (val, 8)
-
-
-class PyFloatsSerDe(PyObjectSerDe):
-  '''Implements a floating point encoding scheme where each value is written
-     as a 32-bit floating point value.'''
-  def get_size(self, item):
-    return int(4)
-
-  def to_bytes(self, item):
-    return struct.pack('<f', item)
-
-  def from_bytes(self, data: bytes, offset: int):
-    val = struct.unpack_from('<f', data, offset)[0]
-    return (val, 4)
-
-
-class PyDoublesSerDe(PyObjectSerDe):
-  '''Implements a floating point encoding scheme where each value is written
-     as a 64-bit floating point value.'''
-  def get_size(self, item):
-    return int(8)
-
-  def to_bytes(self, item):
-    return struct.pack('<d', item)
-
-  def from_bytes(self, data: bytes, offset: int):
-    val = struct.unpack_from('<d', data, offset)[0]
-    return (val, 8)
+#
+# Implementations may also define a batched form of the last two, which
+# sketches then call once for all their items instead of once per item:
+#   * to_bytes_many(items) takes a list of items and returns a bytes
+#     object with their serialized images concatenated
+#   * from_bytes_many(data, offset, count) takes a read-only memoryview
+#     over the serialized data, an offset and the number of items to read,
+#     and returns a tuple with a list of the reconstructed objects and the
+#     total number of bytes read. The memoryview is released once the
+#     method returns, so neither it nor any array or buffer taken from it
+#     may be kept.
+#
+# For example, the equivalent of PyLongsSerDe in Python is:
+#
+#   class LongsSerDe(PyObjectSerDe):
+#     def get_size(self, item):
+#       return int(8)
+#
+#     def to_bytes(self, item):
+#       return struct.pack('<q', item)
+#
+#     def from_bytes(self, data: bytes, offset: int):
+#       val = struct.unpack_from('<q', data, offset)[0]
+#       return (val, 8)
+#
+#     def to_bytes_many(self, items):
+#       return struct.pack(f'<{len(items)}q', *items)
+#
+#     def from_bytes_many(self, data, offset: int, count: int):
+#       return (list(struct.unpack_from(f'<{count}q', data, offset)), 8 * count)
@@ -0,0 +1,122 @@
+# Licensed to the Apache Software Foundation (ASF) under one
+# or more contributor license agreements.  See the NOTICE file
+# distributed with this work for additional information
+# regarding copyright ownership.  The ASF licenses this file
+# to you under the Apache License, Version 2.0 (the
+# "License"); you may not use this file except in compliance
+# with the License.  You may obtain a copy of the License at
+#
+#   http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing,
+# software distributed under the License is distributed on an
+# "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+# KIND, either express or implied.  See the License for the
+# specific language governing permissions and limitations
+# under the License.
+
+import copy
+import threading
+from contextlib import ExitStack
+
+# This file provides an opt-in locking mode for sharing a single sketch
+# across threads, which matters most on free-threaded (no-GIL) builds
+# of CPython. Sketches used from one thread at a time, or only read
+# from many threads, need no wrapper and pay no locking cost.
+
+class SynchronizedSketch:
+  '''Wraps a sketch so that it may be updated and queried concurrently
+     from many threads. Every method and property of the wrapped sketch is
+     available and runs while holding a per-sketch lock. Wrapped sketches
+     passed as arguments, for instance to merge(), are unwrapped and locked
+     as well, including those held directly in a list or tuple argument.
+     Module-level functions such as parallel_merge() and ks_test_many() do
+     not know about the wrapper: call them through :meth:`call`.
+
+     :param sketch: the sketch to protect
+     :type sketch: any sketch object
+    '''
+
+  def __init__(self, sketch):
+    self._sketch = sketch
+    self._lock = threading.RLock()
+
+  @property
+  def sketch(self):
+    '''The wrapped sketch. Accessing it directly bypasses the lock.'''
+    return self._sketch
+
+  @property
+  def lock(self):
+    '''The re-entrant lock guarding the sketch, for grouping several calls atomically.'''
+    return self._lock
+
+  def __getattr__(self, name):
+    # private and special names are never forwarded, which also keeps this
+    # from recursing on an instance whose __init__ did not run
+    if name.startswith('_'):
+      raise AttributeError(name)
+    with self._lock:
+      attr = getattr(self._sketch, name)
+    if not callable(attr):
+      return attr
+
+    def locked(*args, **kwargs):
+      return self._call(attr, args, kwargs)
+    locked.__name__ = name
+    locked.__doc__ = attr.__doc__
+    # cache the wrapper so later lookups skip __getattr__
+    self.__dict__[name] = locked
+    return locked
+
+  @staticmethod
+  def call(func, *args, **kwargs):
+    '''Calls func with the given arguments while holding the lock of every
+       wrapped sketch among them, passing the wrapped sketches in their place.
+       Sketches held directly in a list or tuple argument are unwrapped too,
+       so a list of wrapped sketches may be given to parallel_merge().
+
+       :param func: the function to call
+       :type func: callable
+       :return: the result of func
+    '''
+    return _call_locked(func, args, kwargs, [])
+
+  def _call(self, method, args, kwargs):
+    return _call_locked(method, args, kwargs, [self])
+
+  def __str__(self):
+    with self._lock:
+      return str(self._sketch)
+
+  def __repr__(self):
+    return 'SynchronizedSketch(' + type(self._sketch).__name__ + ')'
+
+  def __copy__(self):
+    with self._lock:
+      return SynchronizedSketch(copy.copy(self._sketch))
+
+  def __iter__(self):
+    # iterate over a snapshot so the lock is not held by the caller's loop
+    with self._lock:
+      return iter(list(self._sketch))
+
+
+def _unwrap(value, wrapped):
+  if isinstance(value, SynchronizedSketch):
+    wrapped.append(value)
+    return value._sketch
+  if isinstance(value, (list, tuple)) and any(isinstance(v, SynchronizedSketch) for v in value):
+    return type(value)(_unwrap(v, wrapped) if isinstance(v, SynchronizedSketch) else v for v in value)
+  return value
+
+def _call_locked(func, args, kwargs, wrapped):
+  args = [_unwrap(a, wrapped) for a in args]
+  kwargs = {k: _unwrap(v, wrapped) for k, v in kwargs.items()}
+  # take every lock in a consistent order to avoid deadlocks between
+  # concurrent calls such as a.merge(b) and b.merge(a)
+  locks = {id(s): s._lock for s in wrapped}
+  with ExitStack() as stack:
+    for key in sorted(locks):
+      stack.enter_context(locks[key])
+    return func(*args, **kwargs)
@@ -28,3 +28,4 @@ from _datasketches import *
 from .PySerDe import *
 from .TuplePolicy import *
 from .KernelFunction import *
+from .SynchronizedSketch import *
@@ -0,0 +1,62 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _GIL_RELEASE_HPP_
+#define _GIL_RELEASE_HPP_
+
+#include <type_traits>
+
+#include <nanobind/nanobind.h>
+
+namespace nb = nanobind;
+
+/*
+  This header defines helpers for running sketch operations from several
+  Python threads. The GIL is only released while working on data that no
+  other thread can reach: local copies, new objects and pinned input
+  buffers. A sketch owned by Python may be used by another thread as soon
+  as the GIL is released, so every method reading or modifying one, or
+  reading a second sketch passed as an argument, keeps the GIL, and the
+  result of work done without it is merged into the sketch afterwards.
+*/
+
+// KLL, REQ and classic quantiles sketches sort level zero and build their
+// sorted view lazily from within const queries, and t-digest merges its
+// buffer the same way. Doing that while the GIL is still held keeps
+// concurrent readers from racing to mutate the sketch. Free-threaded
+// builds have no GIL to rely on, so the sketch's own lock is taken instead,
+// which lets read-only queries from many threads proceed without a wrapper.
+template<typename T, typename SK, typename std::enable_if<!std::is_same<T, nb::object>::value, bool>::type = 0>
+void prepare_sorted_view(const SK& sk) {
+  if (sk.is_empty()) return;
+#if defined(NB_FREE_THREADED)
+  nb::handle self = nb::find(sk);
+  if (self.is_valid()) {
+    nb::ft_object_guard guard(self);
+    sk.get_quantile(0.5);
+    return;
+  }
+#endif
+  sk.get_quantile(0.5);
+}
+
+template<typename T, typename SK, typename std::enable_if<std::is_same<T, nb::object>::value, bool>::type = 0>
+void prepare_sorted_view(const SK&) {}
+
+#endif // _GIL_RELEASE_HPP_
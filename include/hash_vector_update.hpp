@@ -0,0 +1,93 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _HASH_VECTOR_UPDATE_HPP_
+#define _HASH_VECTOR_UPDATE_HPP_
+
+/*
+  This header defines the numpy array updates shared across
+  the set of hash-based distinct counting sketches.
+*/
+
+#include <cstdint>
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+
+#include "py_string_array.hpp"
+
+namespace nb = nanobind;
+
+// Feeds every element of a 1-dimensional array to the sketch.
+// Strided arrays are read in place. The GIL is kept, as the sketch is
+// owned by Python and may be used from other threads.
+// Each element is hashed exactly as the equivalent scalar update would.
+template<typename V, typename SK, typename... Ts>
+void add_hash_vector_update(nb::class_<SK, Ts...>& clazz, const char* docstring) {
+  clazz.def(
+    "update",
+    [](SK& sk, nb::ndarray<const V, nb::ndim<1>, nb::device::cpu> items) {
+      const V* data = items.data();
+      const int64_t stride = items.stride(0);
+      const int64_t n = static_cast<int64_t>(items.shape(0));
+      for (int64_t i = 0; i < n; ++i) sk.update(data[i * stride]);
+    },
+    nb::arg("array"),
+    docstring
+  );
+}
+
+template<typename SK, typename... Ts>
+void add_hash_vector_updates(nb::class_<SK, Ts...>& clazz) {
+  add_hash_vector_update<int64_t>(clazz, "Updates the sketch with each signed 64-bit integer in the given array");
+  add_hash_vector_update<uint64_t>(clazz, "Updates the sketch with each unsigned 64-bit integer in the given array");
+  add_hash_vector_update<double>(clazz, "Updates the sketch with each 64-bit floating point value in the given array");
+}
+
+// Batches of strings, hashed the same way as a single str or bytes item.
+// Empty strings are ignored, as in the scalar string update.
+template<typename SK, typename... Ts>
+void add_string_vector_updates(nb::class_<SK, Ts...>& clazz) {
+  clazz.def(
+    "update_strings",
+    [](SK& sk, nb::handle items) {
+      datasketches::for_each_string(items, [&sk](const char* data, size_t length) {
+        if (length > 0) sk.update(data, length);
+      });
+    },
+    nb::arg("items"),
+    "Updates the sketch with each string in the given numpy array of dtype S, U or object, "
+    "or in a sequence of str or bytes. None elements are skipped."
+  )
+  .def(
+    "update_strings_from_buffers",
+    [](SK& sk, nb::handle offsets, nb::handle data) {
+      datasketches::for_each_string(offsets, data, [&sk](const char* chars, size_t length) {
+        if (length > 0) sk.update(chars, length);
+      });
+    },
+    nb::arg("offsets"), nb::arg("data"),
+    "Updates the sketch with each string of a variable-width layout, such as the buffers of an "
+    "Apache Arrow utf8 array, where string i is data[offsets[i]:offsets[i+1]].\n\n"
+    ":param offsets: n + 1 positions into data\n:type offsets: numpy array of int32 or int64\n"
+    ":param data: the concatenated string bytes\n:type data: any object supporting the buffer protocol"
+  );
+}
+
+#endif // _HASH_VECTOR_UPDATE_HPP_
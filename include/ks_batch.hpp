@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _KS_BATCH_HPP_
+#define _KS_BATCH_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parallel_reduce.hpp"
+
+/*
+  This header defines a batched Kolmogorov-Smirnov test over many pairs
+  of KLL or classic quantiles sketches, following the same statistic and
+  threshold as kolmogorov_smirnov::test(). The sorted view of each
+  distinct sketch is built once, even if it takes part in several pairs,
+  and both the views and the tests are spread over native threads.
+  The sketches must not be reachable from other threads while they are
+  tested, as building a view may sort level zero, so callers pass copies
+  taken with the GIL held or hold the lock of the sketches' owner.
+*/
+
+namespace datasketches {
+
+// The largest distance between the empirical CDFs of two sorted views
+template<typename View, typename C>
+double ks_delta(const View& view_1, uint64_t n_1, const View& view_2, uint64_t n_2, const C& comparator) {
+  auto it_1 = view_1.begin();
+  auto it_2 = view_2.begin();
+  double cdf_1 = 0;
+  double cdf_2 = 0;
+  double delta = 0;
+  while (it_1 != view_1.end() || it_2 != view_2.end()) {
+    // step to the next distinct item of either view
+    const auto item = (it_2 == view_2.end() || (it_1 != view_1.end() && !comparator((*it_2).first, (*it_1).first)))
+      ? (*it_1).first : (*it_2).first;
+    for (; it_1 != view_1.end() && !comparator(item, (*it_1).first); ++it_1) {
+      cdf_1 = static_cast<double>(it_1.get_cumulative_weight(true)) / n_1;
+    }
+    for (; it_2 != view_2.end() && !comparator(item, (*it_2).first); ++it_2) {
+      cdf_2 = static_cast<double>(it_2.get_cumulative_weight(true)) / n_2;
+    }
+    delta = std::max(delta, std::abs(cdf_1 - cdf_2));
+  }
+  return delta;
+}
+
+// The statistic above which the null hypothesis is rejected at level p
+template<typename SK>
+double ks_threshold(const SK& sketch_1, const SK& sketch_2, double p) {
+  const double r_1 = sketch_1.get_num_retained();
+  const double r_2 = sketch_2.get_num_retained();
+  const double alpha_factor = std::sqrt(-0.5 * std::log(0.5 * p));
+  const double delta_area_threshold = alpha_factor * std::sqrt((r_1 + r_2) / (r_1 * r_2));
+  return delta_area_threshold + sketch_1.get_normalized_rank_error(false) + sketch_2.get_normalized_rank_error(false);
+}
+
+// Tests sketches_1[i] against sketches_2[i] for every i, writing whether the
+// null hypothesis is rejected and the statistic of each pair. Pairs with an
+// empty sketch are not rejected and have a statistic of 0.
+template<typename SK>
+void ks_test_pairs(const std::vector<const SK*>& sketches_1, const std::vector<const SK*>& sketches_2,
+                   double p, unsigned num_threads, bool* rejected, double* statistics) {
+  if (sketches_1.size() != sketches_2.size()) {
+    throw std::invalid_argument("Must have the same number of sketches on both sides: "
+      + std::to_string(sketches_1.size()) + " and " + std::to_string(sketches_2.size()));
+  }
+  const size_t num_pairs = sketches_1.size();
+
+  // index the distinct non-empty sketches, so that a shared baseline has a single view
+  std::unordered_map<const SK*, size_t> view_index;
+  std::vector<const SK*> distinct;
+  std::vector<size_t> pair_views(2 * num_pairs);
+  for (size_t i = 0; i < 2 * num_pairs; ++i) {
+    const SK* sketch = i < num_pairs ? sketches_1[i] : sketches_2[i - num_pairs];
+    if (sketch->is_empty()) continue;
+    auto inserted = view_index.emplace(sketch, distinct.size());
+    if (inserted.second) distinct.push_back(sketch);
+    pair_views[i] = inserted.first->second;
+  }
+
+  using view_type = decltype(std::declval<const SK&>().get_sorted_view());
+  std::vector<std::optional<view_type>> views(distinct.size());
+  num_threads = resolve_num_threads(num_threads);
+  {
+    std::atomic<size_t> next(0);
+    run_in_threads(static_cast<unsigned>(std::min<size_t>(num_threads, std::max<size_t>(distinct.size(), 1))),
+      [&](unsigned) {
+        for (size_t v = next++; v < distinct.size(); v = next++) views[v].emplace(distinct[v]->get_sorted_view());
+      });
+  }
+
+  std::atomic<size_t> next(0);
+  run_in_threads(static_cast<unsigned>(std::min<size_t>(num_threads, std::max<size_t>(num_pairs, 1))),
+    [&](unsigned) {
+      for (size_t i = next++; i < num_pairs; i = next++) {
+        const SK& sketch_1 = *sketches_1[i];
+        const SK& sketch_2 = *sketches_2[i];
+        if (sketch_1.is_empty() || sketch_2.is_empty()) {
+          rejected[i] = false;
+          statistics[i] = 0;
+          continue;
+        }
+        const double delta = ks_delta(*views[pair_views[i]], sketch_1.get_n(),
+                                      *views[pair_views[num_pairs + i]], sketch_2.get_n(),
+                                      sketch_1.get_comparator());
+        rejected[i] = delta > ks_threshold(sketch_1, sketch_2, p);
+        statistics[i] = delta;
+      }
+    });
+}
+
+}
+
+#endif // _KS_BATCH_HPP_
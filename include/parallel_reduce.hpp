@@ -0,0 +1,111 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _PARALLEL_REDUCE_HPP_
+#define _PARALLEL_REDUCE_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+  This header defines helpers for spreading sketch work over native
+  threads. None of them touch the Python interpreter, so callers are
+  expected to have released the GIL and to pass only C++ state.
+*/
+
+namespace datasketches {
+
+// 0 requests one thread per hardware thread
+static inline unsigned resolve_num_threads(unsigned num_threads) {
+  if (num_threads == 0) num_threads = std::thread::hardware_concurrency();
+  return std::max(num_threads, 1u);
+}
+
+// Calls func(thread_index) on num_threads threads, including the calling one,
+// and rethrows the first exception once every thread has finished.
+template<typename F>
+void run_in_threads(unsigned num_threads, F&& func) {
+  if (num_threads <= 1) {
+    func(0u);
+    return;
+  }
+  std::vector<std::exception_ptr> errors(num_threads);
+  auto run = [&func, &errors](unsigned t) {
+    try {
+      func(t);
+    } catch (...) {
+      errors[t] = std::current_exception();
+    }
+  };
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  try {
+    for (unsigned t = 1; t < num_threads; ++t) threads.emplace_back(run, t);
+  } catch (...) {
+    for (auto& thread: threads) thread.join();
+    throw;
+  }
+  run(0);
+  for (auto& thread: threads) thread.join();
+  for (auto& error: errors) {
+    if (error) std::rethrow_exception(error);
+  }
+}
+
+// Folds n inputs into per-thread accumulators, then combines those pairwise
+// in rounds of a tree reduction.
+// fold(std::optional<Acc>&, size_t i) adds input i, initializing an empty accumulator.
+// combine(Acc&, Acc&&) merges the second accumulator into the first.
+// Inputs are handed out through a shared counter, which balances the threads
+// when inputs differ in size. Returns an empty optional if there are no inputs.
+template<typename Acc, typename Fold, typename Combine>
+std::optional<Acc> tree_reduce(size_t n, unsigned num_threads, Fold&& fold, Combine&& combine) {
+  if (n == 0) return std::nullopt;
+  num_threads = static_cast<unsigned>(std::min<size_t>(resolve_num_threads(num_threads), n));
+
+  std::vector<std::optional<Acc>> partial(num_threads);
+  std::atomic<size_t> next(0);
+  run_in_threads(num_threads, [&](unsigned t) {
+    for (size_t i = next++; i < n; i = next++) fold(partial[t], i);
+  });
+
+  for (size_t stride = 1; stride < num_threads; stride *= 2) {
+    std::vector<size_t> targets;
+    for (size_t i = 0; i + stride < num_threads; i += 2 * stride) targets.push_back(i);
+    run_in_threads(static_cast<unsigned>(targets.size()), [&](unsigned p) {
+      std::optional<Acc>& target = partial[targets[p]];
+      std::optional<Acc>& source = partial[targets[p] + stride];
+      if (!source) return;
+      if (target) combine(*target, std::move(*source));
+      else target.emplace(std::move(*source));
+      source.reset();
+    });
+  }
+  return std::move(partial[0]);
+}
+
+}
+
+#endif // _PARALLEL_REDUCE_HPP_
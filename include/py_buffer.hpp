@@ -0,0 +1,103 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _PY_BUFFER_HPP_
+#define _PY_BUFFER_HPP_
+
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
+
+namespace nb = nanobind;
+
+namespace datasketches {
+
+/*
+  This header defines an owner for a view obtained through the
+  Python buffer protocol. The exporting object stays pinned while
+  the view is held, so the memory may be read without the GIL.
+  Acquiring and releasing the view both require the GIL.
+  Optionally, the view may be limited to a byte range, which lets
+  sketches be deserialized in place from a slice of a larger buffer.
+*/
+
+class py_buffer {
+public:
+  py_buffer(nb::handle obj, int flags) {
+    view_.obj = nullptr;
+    if (PyObject_GetBuffer(obj.ptr(), &view_, flags) != 0) throw nb::python_error();
+    data_ = static_cast<const char*>(view_.buf);
+    size_ = static_cast<size_t>(view_.len);
+  }
+
+  // contiguous, read-only view of length bytes starting at offset, or of
+  // the rest of the buffer if no length is given
+  py_buffer(nb::handle obj, size_t offset, const std::optional<size_t>& length):
+  py_buffer(obj, PyBUF_SIMPLE) {
+    if (offset > size_) {
+      throw std::out_of_range("offset " + std::to_string(offset)
+        + " is beyond the end of a buffer of " + std::to_string(size_) + " bytes");
+    }
+    const size_t available = size_ - offset;
+    if (length && *length > available) {
+      throw std::out_of_range("requested " + std::to_string(*length) + " bytes at offset "
+        + std::to_string(offset) + " but only " + std::to_string(available) + " are available");
+    }
+    data_ += offset;
+    size_ = length ? *length : available;
+  }
+
+  ~py_buffer() {
+    if (view_.obj != nullptr) PyBuffer_Release(&view_);
+  }
+
+  py_buffer(py_buffer&& other) noexcept: view_(other.view_), data_(other.data_), size_(other.size_) {
+    other.view_.obj = nullptr;
+  }
+
+  py_buffer(const py_buffer&) = delete;
+  py_buffer& operator=(const py_buffer&) = delete;
+  py_buffer& operator=(py_buffer&&) = delete;
+
+  const Py_buffer& view() const { return view_; }
+  const char* data() const { return data_; }
+  size_t size() const { return size_; }
+
+private:
+  Py_buffer view_;
+  const char* data_;
+  size_t size_;
+};
+
+// Acquires a contiguous view of each element of a sequence of buffers, such as a
+// list of bytes objects holding serialized sketches. Requires the GIL.
+static inline std::vector<py_buffer> get_buffers(nb::handle buffers) {
+  std::vector<py_buffer> views;
+  for (nb::handle buffer: buffers) views.emplace_back(buffer, PyBUF_SIMPLE);
+  return views;
+}
+
+}
+
+#endif // _PY_BUFFER_HPP_
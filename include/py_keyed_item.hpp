@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _PY_KEYED_ITEM_HPP_
+#define _PY_KEYED_ITEM_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include <nanobind/nanobind.h>
+
+#include "py_serde.hpp"
+
+namespace nb = nanobind;
+
+/*
+  This header defines a Python item paired with a native sort key, so
+  that sketches ordering arbitrary objects can compare them without
+  calling into Python. The key is computed once per item, either by a
+  user-provided key function, as with sorted(key=...), or from the item
+  itself. Keys are ints, floats, str or bytes; ints and floats compare
+  by value and both sort before strings, which compare by their UTF-8
+  bytes. As the items are Python objects, the GIL must be held whenever
+  they are copied or destroyed.
+
+  NOTE: This header must be included before the inclusion of
+        any sketch classes.
+*/
+
+namespace datasketches {
+
+using py_sort_key = std::variant<int64_t, double, std::string>;
+
+struct py_keyed_item {
+  py_sort_key key;
+  nb::object item;
+};
+
+// Converts a Python value to a native sort key
+static inline py_sort_key make_sort_key(nb::handle value) {
+  if (nb::isinstance<nb::float_>(value)) {
+    const double d = nb::cast<double>(value);
+    if (std::isnan(d)) throw std::invalid_argument("sort keys cannot be NaN");
+    return d;
+  }
+  if (nb::isinstance<nb::int_>(value)) {
+    int overflow = 0;
+    const long long i = PyLong_AsLongLongAndOverflow(value.ptr(), &overflow);
+    if (overflow != 0) {
+      PyErr_SetString(PyExc_OverflowError, "int sort keys must fit in a signed 64-bit integer");
+      throw nb::python_error();
+    }
+    if (i == -1 && PyErr_Occurred()) throw nb::python_error();
+    return static_cast<int64_t>(i);
+  }
+  if (nb::isinstance<nb::str>(value)) {
+    Py_ssize_t size = 0;
+    const char* data = PyUnicode_AsUTF8AndSize(value.ptr(), &size);
+    if (data == nullptr) throw nb::python_error();
+    return std::string(data, static_cast<size_t>(size));
+  }
+  if (nb::isinstance<nb::bytes>(value)) {
+    nb::bytes bytes = nb::borrow<nb::bytes>(value);
+    return std::string(bytes.c_str(), bytes.size());
+  }
+  throw nb::type_error("sort keys must be int, float, str or bytes");
+}
+
+// Computes the sort key of an item, applying the key function unless it is None
+static inline py_keyed_item make_keyed_item(const nb::object& key_func, nb::object item) {
+  py_sort_key key = make_sort_key(key_func.is_none() ? item : key_func(item));
+  return py_keyed_item{std::move(key), std::move(item)};
+}
+
+// A query point given directly by its sort key, bypassing the key function
+static inline py_keyed_item make_key_point(nb::handle key) {
+  return py_keyed_item{make_sort_key(key), nb::none()};
+}
+
+// Orders items by their keys only. Also carries the key function, which the
+// sketches keep with their comparator so it is available for later updates.
+struct py_keyed_item_lt {
+  nb::object key_func;
+
+  py_keyed_item_lt(): key_func(nb::none()) {}
+  explicit py_keyed_item_lt(nb::object key_func): key_func(std::move(key_func)) {}
+
+  py_keyed_item make(nb::object item) const {
+    return make_keyed_item(key_func, std::move(item));
+  }
+
+  bool operator()(const py_keyed_item& a, const py_keyed_item& b) const {
+    const size_t ia = a.key.index();
+    const size_t ib = b.key.index();
+    if (ia == ib) return a.key < b.key;
+    // an int and a float; long double represents both exactly where it is wider than double
+    if (ia < 2 && ib < 2) return as_number(a.key) < as_number(b.key);
+    return ia < ib;
+  }
+
+private:
+  static long double as_number(const py_sort_key& key) {
+    if (key.index() == 0) return static_cast<long double>(std::get<int64_t>(key));
+    return static_cast<long double>(std::get<double>(key));
+  }
+};
+
+static std::ostream& operator<<(std::ostream& os, const py_keyed_item& item) {
+  os << std::string(nb::str(item.item).c_str());
+  return os;
+}
+
+// Serializes only the items, with the provided py_object_serde, so the format
+// is the same as for a sketch of plain items. Keys are recomputed on deserialization.
+struct py_keyed_item_serde {
+  const py_object_serde& serde;
+  const py_keyed_item_lt& comparator;
+
+  size_t size_of_item(const py_keyed_item& item) const {
+    return serde.size_of_item(item.item);
+  }
+
+  size_t serialize(void* ptr, size_t capacity, const py_keyed_item* items, unsigned num) const {
+    const auto objects = get_objects(items, num);
+    return serde.serialize(ptr, capacity, objects.data(), num);
+  }
+
+  void serialize(std::ostream& os, const py_keyed_item* items, unsigned num) const {
+    const auto objects = get_objects(items, num);
+    serde.serialize(os, objects.data(), num);
+  }
+
+  size_t deserialize(const void* ptr, size_t capacity, py_keyed_item* items, unsigned num) const {
+    // null handles, constructed over in place by the serde
+    std::vector<nb::object> objects(num);
+    const size_t bytes_read = serde.deserialize(ptr, capacity, objects.data(), num);
+    unsigned i = 0;
+    try {
+      for (; i < num; ++i) new (&items[i]) py_keyed_item(comparator.make(std::move(objects[i])));
+    } catch (...) {
+      for (unsigned j = 0; j < i; ++j) items[j].~py_keyed_item();
+      throw;
+    }
+    return bytes_read;
+  }
+
+private:
+  static std::vector<nb::object> get_objects(const py_keyed_item* items, unsigned num) {
+    std::vector<nb::object> objects;
+    objects.reserve(num);
+    for (unsigned i = 0; i < num; ++i) objects.push_back(items[i].item);
+    return objects;
+  }
+};
+
+}
+
+#endif // _PY_KEYED_ITEM_HPP_
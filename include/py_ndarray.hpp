@@ -0,0 +1,53 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _PY_NDARRAY_HPP_
+#define _PY_NDARRAY_HPP_
+
+#include <cstddef>
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+
+namespace nb = nanobind;
+
+/*
+  This header defines helpers for returning query results to Python
+  as numpy arrays owned by the array itself.
+*/
+
+namespace datasketches {
+
+template<typename V>
+using numpy_array = nb::ndarray<V, nb::numpy, nb::ndim<1>>;
+
+// Allocates an uninitialized 1-dimensional array. Requires the GIL,
+// but the returned data may be filled in without it.
+template<typename V>
+numpy_array<V> make_numpy_array(size_t size) {
+  V* data = new V[size];
+  nb::capsule owner(data, [](void *p) noexcept {
+    delete[] static_cast<V*>(p);
+  });
+  return numpy_array<V>(data, {size}, owner);
+}
+
+}
+
+#endif // _PY_NDARRAY_HPP_
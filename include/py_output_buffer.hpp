@@ -0,0 +1,128 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _PY_OUTPUT_BUFFER_HPP_
+#define _PY_OUTPUT_BUFFER_HPP_
+
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <streambuf>
+#include <string>
+
+#include <nanobind/nanobind.h>
+
+#include "py_buffer.hpp"
+
+namespace nb = nanobind;
+
+/*
+  This header defines helpers for serializing sketches directly into
+  Python-owned memory, either a new bytes object or a caller-provided
+  writable buffer, using the std::ostream form of each sketch's
+  serialize method. This avoids building an intermediate std::vector
+  only to copy it again.
+  Each helper takes a callable write(std::ostream&), which is invoked
+  with the GIL held, as it reads a sketch owned by Python.
+*/
+
+namespace datasketches {
+
+// writes into a fixed region of memory, failing once it is full
+class memory_streambuf: public std::streambuf {
+public:
+  memory_streambuf(char* data, size_t capacity) {
+    setp(data, data + capacity);
+  }
+
+  size_t size() const { return static_cast<size_t>(pptr() - pbase()); }
+};
+
+// discards its input, counting the bytes
+class counting_streambuf: public std::streambuf {
+public:
+  size_t size() const { return size_; }
+
+protected:
+  std::streamsize xsputn(const char*, std::streamsize n) override {
+    size_ += static_cast<size_t>(n);
+    return n;
+  }
+
+  int_type overflow(int_type ch) override {
+    if (!traits_type::eq_int_type(ch, traits_type::eof())) ++size_;
+    return traits_type::not_eof(ch);
+  }
+
+private:
+  size_t size_ = 0;
+};
+
+// Serializes into a new bytes object of exactly the given size
+template<typename F>
+nb::bytes serialize_to_bytes(size_t size, F&& write) {
+  nb::bytes bytes = nb::steal<nb::bytes>(PyBytes_FromStringAndSize(nullptr, static_cast<Py_ssize_t>(size)));
+  if (!bytes.is_valid()) throw nb::python_error();
+  memory_streambuf buf(PyBytes_AsString(bytes.ptr()), size);
+  std::ostream os(&buf);
+  write(os);
+  if (!os.good() || buf.size() != size) {
+    throw std::runtime_error("serialized " + std::to_string(buf.size())
+      + " bytes but the sketch reported a size of " + std::to_string(size));
+  }
+  return bytes;
+}
+
+// Serializes size bytes into a writable buffer starting at offset, returning the
+// number of bytes written. The space is checked before anything is written, so a
+// buffer that is too small is left untouched.
+template<typename F>
+size_t serialize_into(nb::handle buffer, size_t offset, size_t size, F&& write) {
+  py_buffer target(buffer, PyBUF_WRITABLE);
+  if (offset > target.size()) {
+    throw std::out_of_range("offset " + std::to_string(offset)
+      + " is beyond the end of a buffer of " + std::to_string(target.size()) + " bytes");
+  }
+  const size_t capacity = target.size() - offset;
+  if (size > capacity) {
+    throw std::length_error("insufficient space to serialize the sketch: " + std::to_string(size)
+      + " bytes needed, " + std::to_string(capacity) + " available after offset " + std::to_string(offset));
+  }
+  memory_streambuf buf(static_cast<char*>(target.view().buf) + offset, size);
+  std::ostream os(&buf);
+  write(os);
+  if (!os.good() || buf.size() != size) {
+    throw std::runtime_error("serialized " + std::to_string(buf.size())
+      + " bytes but the sketch reported a size of " + std::to_string(size));
+  }
+  return size;
+}
+
+// Returns the number of bytes produced by write, without storing them
+template<typename F>
+size_t count_serialized_bytes(F&& write) {
+  counting_streambuf buf;
+  std::ostream os(&buf);
+  write(os);
+  return buf.size();
+}
+
+}
+
+#endif // _PY_OUTPUT_BUFFER_HPP_
@@ -19,8 +19,13 @@
 
 #include <nanobind/nanobind.h>
 #include <nanobind/trampoline.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <sstream>
 
+#include "memory_operations.hpp"
+
 #ifndef _PY_SERDE_HPP_
 #define _PY_SERDE_HPP_
 
@@ -28,6 +33,33 @@ namespace nb = nanobind;
 
 namespace datasketches {
 
+namespace serde_bytes {
+
+static inline bool is_little_endian() {
+  const uint16_t probe = 1;
+  return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+}
+
+// writes value at out in little-endian byte order, whatever the host order
+template<typename T>
+void store_le(char* out, T value) {
+  std::memcpy(out, &value, sizeof(T));
+  if (!is_little_endian()) std::reverse(out, out + sizeof(T));
+}
+
+// reads a little-endian value of type T at in, whatever the host order
+template<typename T>
+T load_le(const char* in) {
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, in, sizeof(T));
+  if (!is_little_endian()) std::reverse(bytes, bytes + sizeof(T));
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+} // namespace serde_bytes
+
 /**
  * @brief The py_object_serde is an abstract class that implements the
  * datasketches serde interface, and is used to allow custom Python
@@ -65,9 +97,141 @@ struct py_object_serde {
 
   // these methods are required by the serde interface; see common/include/serde.hpp for
   // default implementations for C++ std::string and numeric types.
-  size_t size_of_item(const nb::object& item) const;
-  size_t serialize(void* ptr, size_t capacity, const nb::object* items, unsigned num) const;
-  size_t deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const;
+  // The defaults call the three methods above once per item. Native serdes
+  // override them to process all items without dispatching to Python.
+  virtual size_t size_of_item(const nb::object& item) const;
+  virtual size_t serialize(void* ptr, size_t capacity, const nb::object* items, unsigned num) const;
+  virtual void serialize(std::ostream& os, const nb::object* items, unsigned num) const;
+  virtual size_t deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const;
+};
+
+/**
+ * @brief Serializes str items as a 4-byte little-endian byte count followed
+ * by the UTF-8 encoding of the string, with no null termination. This is
+ * the format used by the C++ and Java libraries for strings.
+ */
+struct py_strings_serde : public py_object_serde {
+  int64_t get_size(const nb::object& item) const override;
+  nb::bytes to_bytes(const nb::object& item) const override;
+  nb::tuple from_bytes(nb::bytes& bytes, size_t offset) const override;
+
+  size_t size_of_item(const nb::object& item) const override;
+  size_t serialize(void* ptr, size_t capacity, const nb::object* items, unsigned num) const override;
+  void serialize(std::ostream& os, const nb::object* items, unsigned num) const override;
+  size_t deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const override;
+};
+
+/**
+ * @brief Serializes Python int or float items as fixed-width little-endian
+ * values of type T, matching struct.pack with the equivalent format.
+ */
+template<typename T>
+struct py_numeric_serde : public py_object_serde {
+  int64_t get_size(const nb::object&) const override { return sizeof(T); }
+
+  nb::bytes to_bytes(const nb::object& item) const override {
+    char bytes[sizeof(T)];
+    serde_bytes::store_le(bytes, nb::cast<T>(item));
+    return nb::bytes(bytes, sizeof(T));
+  }
+
+  nb::tuple from_bytes(nb::bytes& bytes, size_t offset) const override {
+    check_memory_size(offset + sizeof(T), bytes.size());
+    return nb::make_tuple(serde_bytes::load_le<T>(bytes.c_str() + offset), sizeof(T));
+  }
+
+  size_t size_of_item(const nb::object&) const override { return sizeof(T); }
+
+  size_t serialize(void* ptr, size_t capacity, const nb::object* items, unsigned num) const override {
+    const size_t bytes_written = num * sizeof(T);
+    check_memory_size(bytes_written, capacity);
+    nb::gil_scoped_acquire acquire;
+    char* out = static_cast<char*>(ptr);
+    for (unsigned i = 0; i < num; ++i) {
+      serde_bytes::store_le(out + i * sizeof(T), nb::cast<T>(items[i]));
+    }
+    return bytes_written;
+  }
+
+  void serialize(std::ostream& os, const nb::object* items, unsigned num) const override {
+    nb::gil_scoped_acquire acquire;
+    for (unsigned i = 0; i < num; ++i) {
+      char bytes[sizeof(T)];
+      serde_bytes::store_le(bytes, nb::cast<T>(items[i]));
+      os.write(bytes, sizeof(T));
+    }
+  }
+
+  size_t deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const override {
+    const size_t bytes_read = num * sizeof(T);
+    check_memory_size(bytes_read, capacity);
+    nb::gil_scoped_acquire acquire;
+    const char* in = static_cast<const char*>(ptr);
+    for (unsigned i = 0; i < num; ++i) {
+      new (&items[i]) nb::object(nb::cast(serde_bytes::load_le<T>(in + i * sizeof(T))));
+    }
+    return bytes_read;
+  }
+};
+
+/**
+ * @brief Trampoline for the native serdes, so that a Python subclass
+ * overriding get_size, to_bytes or from_bytes is honored. Such a subclass
+ * is serialized through those per-item methods, as a PyObjectSerDe would
+ * be, while the native classes themselves keep their batched paths.
+ */
+template<typename Base>
+struct PyNativeSerDe : public Base {
+  NB_TRAMPOLINE(Base, 3);
+
+  int64_t get_size(const nb::object& item) const override {
+    NB_OVERRIDE(get_size, item);
+  }
+
+  nb::bytes to_bytes(const nb::object& item) const override {
+    NB_OVERRIDE(to_bytes, item);
+  }
+
+  nb::tuple from_bytes(nb::bytes& bytes, size_t offset) const override {
+    NB_OVERRIDE(from_bytes, bytes, offset);
+  }
+
+  size_t size_of_item(const nb::object& item) const override {
+    if (overrides_item_methods()) return py_object_serde::size_of_item(item);
+    return Base::size_of_item(item);
+  }
+
+  size_t serialize(void* ptr, size_t capacity, const nb::object* items, unsigned num) const override {
+    if (overrides_item_methods()) return py_object_serde::serialize(ptr, capacity, items, num);
+    return Base::serialize(ptr, capacity, items, num);
+  }
+
+  void serialize(std::ostream& os, const nb::object* items, unsigned num) const override {
+    if (overrides_item_methods()) return py_object_serde::serialize(os, items, num);
+    Base::serialize(os, items, num);
+  }
+
+  size_t deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const override {
+    if (overrides_item_methods()) return py_object_serde::deserialize(ptr, capacity, items, num);
+    return Base::deserialize(ptr, capacity, items, num);
+  }
+
+private:
+  // whether the Python class replaces any per-item method of the native one, looked up once
+  bool overrides_item_methods() const {
+    if (overrides_ < 0) {
+      nb::gil_scoped_acquire acquire;
+      nb::handle cls(reinterpret_cast<PyObject*>(Py_TYPE(nb_trampoline.base().ptr())));
+      nb::handle native = nb::type<Base>();
+      overrides_ = 0;
+      for (const char* name: {"get_size", "to_bytes", "from_bytes"}) {
+        if (!cls.attr(name).is(native.attr(name))) overrides_ = 1;
+      }
+    }
+    return overrides_ > 0;
+  }
+
+  mutable int overrides_ = -1;
 };
 
 /**
@@ -100,6 +264,16 @@ struct PyObjectSerDe : public py_object_serde {
       bytes, offset     // Argument(s)
     );
   }
+
+  // Python classes may optionally define to_bytes_many(items) -> bytes and
+  // from_bytes_many(data, offset, count) -> (list, nbytes) to handle all the items
+  // of a sketch in one call. These fall back to the per-item methods otherwise.
+  size_t serialize(void* ptr, size_t capacity, const nb::object* items, unsigned num) const override;
+  void serialize(std::ostream& os, const nb::object* items, unsigned num) const override;
+  size_t deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const override;
+
+private:
+  nb::bytes to_bytes_many(nb::handle method, const nb::object* items, unsigned num) const;
 };
 
 }
@@ -0,0 +1,270 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _PY_STRING_ARRAY_HPP_
+#define _PY_STRING_ARRAY_HPP_
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <nanobind/nanobind.h>
+
+#include "py_buffer.hpp"
+
+namespace nb = nanobind;
+
+/*
+  This header defines readers for batches of strings so that sketches
+  can ingest them in a single C++ loop. Each string is presented as a
+  pointer and a length in bytes, using UTF-8 for unicode text, which
+  matches how a single str or bytes item is hashed by the sketches.
+*/
+
+namespace datasketches {
+
+namespace string_array {
+
+static inline bool is_little_endian() {
+  const uint16_t probe = 1;
+  return *reinterpret_cast<const uint8_t*>(&probe) == 1;
+}
+
+// appends the UTF-8 encoding of a code point, rejecting values Python cannot encode
+static inline void append_utf8(std::string& out, uint32_t cp) {
+  if (cp < 0x80) {
+    out.push_back(static_cast<char>(cp));
+  } else if (cp < 0x800) {
+    out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x10000) {
+    if (cp >= 0xD800 && cp <= 0xDFFF) {
+      throw std::invalid_argument("surrogate code points cannot be encoded as UTF-8");
+    }
+    out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else if (cp < 0x110000) {
+    out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+    out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+  } else {
+    throw std::invalid_argument("invalid code point: " + std::to_string(cp));
+  }
+}
+
+// Resolves str or bytes to UTF-8 data owned by the object. Requires the GIL.
+// Returns false for None, which is treated as a missing value.
+static inline bool get_utf8(PyObject* obj, const char** data, size_t* length) {
+  Py_ssize_t size = 0;
+  if (PyUnicode_Check(obj)) {
+    *data = PyUnicode_AsUTF8AndSize(obj, &size);
+    if (*data == nullptr) throw nb::python_error();
+  } else if (PyBytes_Check(obj)) {
+    char* buf = nullptr;
+    if (PyBytes_AsStringAndSize(obj, &buf, &size) != 0) throw nb::python_error();
+    *data = buf;
+  } else if (obj == Py_None) {
+    return false;
+  } else {
+    throw nb::type_error("string arrays may only contain str, bytes or None");
+  }
+  *length = static_cast<size_t>(size);
+  return true;
+}
+
+}
+
+// Calls func(const char* data, size_t length) for each element of the given strings.
+// Accepts numpy arrays of dtype S (bytes, trailing NULs stripped as numpy does) or
+// U (unicode, encoded to UTF-8), object arrays and other sequences holding str or
+// bytes. None elements are skipped. The callback runs with the GIL held.
+// A single str or bytes is rejected rather than read as a sequence of characters.
+template<typename F>
+void for_each_string(nb::handle items, F&& func) {
+  using namespace string_array;
+
+  if (PyUnicode_Check(items.ptr()) || PyBytes_Check(items.ptr())) {
+    throw nb::type_error("expected a sequence or array of strings, not a single str or bytes object");
+  }
+
+  if (!PyObject_CheckBuffer(items.ptr())) {
+    // generic sequence: resolve every UTF-8 view first, keeping each item alive,
+    // so that an invalid item is reported before any string is passed on
+    std::vector<nb::object> refs;
+    std::vector<std::pair<const char*, size_t>> strings;
+    for (nb::handle item: items) {
+      const char* data;
+      size_t length;
+      if (get_utf8(item.ptr(), &data, &length)) {
+        refs.push_back(nb::borrow(item));
+        strings.emplace_back(data, length);
+      }
+    }
+    for (const auto& s: strings) func(s.first, s.second);
+    return;
+  }
+
+  py_buffer buffer(items, PyBUF_RECORDS_RO);
+  const Py_buffer& view = buffer.view();
+  if (view.ndim != 1) {
+    throw std::invalid_argument("input data must have only one dimension. Found: "
+      + std::to_string(view.ndim));
+  }
+
+  // numpy reports these as e.g. "O", "10s" or "<10w"
+  const char* format = view.format != nullptr ? view.format : "B";
+  bool swap_bytes = false;
+  if (*format == '<' || *format == '>' || *format == '!') {
+    swap_bytes = (*format == '<') != is_little_endian();
+    ++format;
+  } else if (*format == '@' || *format == '=') {
+    ++format;
+  }
+  while (*format >= '0' && *format <= '9') ++format;
+  const char code = *format;
+
+  const char* base = buffer.data();
+  const Py_ssize_t stride = view.strides != nullptr ? view.strides[0] : view.itemsize;
+  const Py_ssize_t n = view.shape != nullptr ? view.shape[0] : view.len / view.itemsize;
+  const size_t itemsize = static_cast<size_t>(view.itemsize);
+
+  if (code == 'O') {
+    // as for sequences, every item is resolved before any string is passed on
+    std::vector<nb::object> refs;
+    std::vector<std::pair<const char*, size_t>> strings;
+    refs.reserve(n);
+    strings.reserve(n);
+    for (Py_ssize_t i = 0; i < n; ++i) {
+      PyObject* obj;
+      std::memcpy(&obj, base + i * stride, sizeof(PyObject*));
+      const char* data;
+      size_t length;
+      if (get_utf8(obj, &data, &length)) {
+        refs.push_back(nb::borrow(obj));
+        strings.emplace_back(data, length);
+      }
+    }
+    for (const auto& s: strings) func(s.first, s.second);
+  } else if (code == 's') {
+    for (Py_ssize_t i = 0; i < n; ++i) {
+      const char* data = base + i * stride;
+      size_t length = itemsize;
+      while (length > 0 && data[length - 1] == '\0') --length;
+      func(data, length);
+    }
+  } else if (code == 'w') {
+    // every string is encoded before any is passed on, as code points that
+    // cannot be encoded would otherwise leave the sketch partly updated
+    const size_t width = itemsize / sizeof(uint32_t);
+    std::string encoded;
+    std::vector<size_t> ends;
+    ends.reserve(n);
+    for (Py_ssize_t i = 0; i < n; ++i) {
+      const char* data = base + i * stride;
+      size_t length = width;
+      uint32_t cp = 0;
+      // trailing NULs are padding
+      while (length > 0) {
+        std::memcpy(&cp, data + (length - 1) * sizeof(uint32_t), sizeof(uint32_t));
+        if (cp != 0) break;
+        --length;
+      }
+      for (size_t j = 0; j < length; ++j) {
+        std::memcpy(&cp, data + j * sizeof(uint32_t), sizeof(uint32_t));
+        if (swap_bytes) {
+          cp = ((cp & 0xFF) << 24) | ((cp & 0xFF00) << 8) | ((cp >> 8) & 0xFF00) | (cp >> 24);
+        }
+        append_utf8(encoded, cp);
+      }
+      ends.push_back(encoded.size());
+    }
+    size_t start = 0;
+    for (size_t end: ends) {
+      func(encoded.data() + start, end - start);
+      start = end;
+    }
+  } else {
+    throw nb::type_error("expected an array of dtype S, U or object, or a sequence of str or bytes");
+  }
+}
+
+// Calls func(const char* data, size_t length) for each string of a variable-width
+// layout such as Apache Arrow's utf8 and binary arrays: offsets is an int32 or int64
+// array of n + 1 positions into data. The callback runs with the GIL held.
+template<typename F>
+void for_each_string(nb::handle offsets, nb::handle data, F&& func) {
+  py_buffer offsets_buffer(offsets, PyBUF_RECORDS_RO);
+  py_buffer data_buffer(data, PyBUF_SIMPLE);
+  const Py_buffer& view = offsets_buffer.view();
+  if (view.ndim != 1) {
+    throw std::invalid_argument("offsets must have only one dimension. Found: "
+      + std::to_string(view.ndim));
+  }
+  const char* format = view.format != nullptr ? view.format : "B";
+  if (*format == '@' || *format == '=' || *format == '<') ++format;
+  const bool is_signed_int = *format == 'i' || *format == 'l' || *format == 'q';
+  if (!is_signed_int || (view.itemsize != 4 && view.itemsize != 8)) {
+    throw nb::type_error("offsets must be an array of int32 or int64");
+  }
+
+  const char* base = offsets_buffer.data();
+  const Py_ssize_t stride = view.strides != nullptr ? view.strides[0] : view.itemsize;
+  const Py_ssize_t num_offsets = view.shape != nullptr ? view.shape[0] : view.len / view.itemsize;
+  const bool wide = view.itemsize == 8;
+  const char* chars = data_buffer.data();
+  const int64_t num_chars = static_cast<int64_t>(data_buffer.size());
+
+  auto read_offset = [base, stride, wide](Py_ssize_t i) -> int64_t {
+    if (wide) {
+      int64_t value;
+      std::memcpy(&value, base + i * stride, sizeof(value));
+      return value;
+    }
+    int32_t value;
+    std::memcpy(&value, base + i * stride, sizeof(value));
+    return value;
+  };
+
+  if (num_offsets < 1) return;
+  // check every offset before passing on any string, so that a bad offset
+  // leaves the sketch untouched rather than partly updated
+  int64_t start = read_offset(0);
+  for (Py_ssize_t i = 1; i < num_offsets; ++i) {
+    const int64_t end = read_offset(i);
+    if (start < 0 || end < start || end > num_chars) {
+      throw std::out_of_range("invalid string offsets at position " + std::to_string(i - 1));
+    }
+    start = end;
+  }
+  start = read_offset(0);
+  for (Py_ssize_t i = 1; i < num_offsets; ++i) {
+    const int64_t end = read_offset(i);
+    func(chars + start, static_cast<size_t>(end - start));
+    start = end;
+  }
+}
+
+}
+
+#endif // _PY_STRING_ARRAY_HPP_
@@ -25,8 +25,20 @@
   across the set of quantile family sketches.
 */
 
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
 #include "common_defs.hpp"
+#include "tdigest.hpp"
+#include "gil_release.hpp"
+#include "parallel_reduce.hpp"
+#include "py_buffer.hpp"
+#include "py_ndarray.hpp"
+#include "py_output_buffer.hpp"
 #include "py_serde.hpp"
+#include "py_string_array.hpp"
 
 #include <nanobind/nanobind.h>
 #include <nanobind/operators.h>
@@ -35,23 +47,85 @@
 
 namespace nb = nanobind;
 
+// t-digest merges its buffer when serialized, so it must be prepared with the
+// GIL held, see prepare_sorted_view(). The other sketches serialize without
+// building a sorted view.
+template<typename SK> struct is_tdigest: std::false_type {};
+template<typename T, typename A> struct is_tdigest<datasketches::tdigest<T, A>>: std::true_type {};
+
+template<typename T, typename SK>
+void prepare_serialization(const SK& sk) {
+  if constexpr (is_tdigest<SK>::value) prepare_sorted_view<T>(sk);
+  else unused(sk);
+}
+
 // Serialization
 // std::string and arithmetic types, where we don't need a separate serde
 template<typename T, typename SK, typename std::enable_if<std::is_arithmetic<T>::value || std::is_same<std::string, T>::value, bool>::type = 0>
 void add_serialization(nb::class_<SK>& clazz) {
+  // t-digest binds its own, with an option to include the buffer
+  if (!nb::hasattr(clazz, "get_serialized_size_bytes")) {
+    clazz.def(
+        "get_serialized_size_bytes",
+        [](const SK& sk) {
+          prepare_serialization<T>(sk);
+          return sk.get_serialized_size_bytes();
+        },
+        "Returns the size of the serialized sketch, in bytes"
+    );
+  }
   clazz.def(
         "serialize",
         [](const SK& sk) {
-          auto bytes = sk.serialize();
-          return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+          prepare_serialization<T>(sk);
+          return datasketches::serialize_to_bytes(sk.get_serialized_size_bytes(), [&sk](std::ostream& os) { sk.serialize(os); });
         },
         "Serializes the sketch into a bytes object."
     )
+    .def(
+        "serialize_into",
+        [](const SK& sk, nb::handle buffer, size_t offset) {
+          prepare_serialization<T>(sk);
+          return datasketches::serialize_into(buffer, offset, sk.get_serialized_size_bytes(), [&sk](std::ostream& os) { sk.serialize(os); });
+        },
+        nb::arg("buffer"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset. "
+        "Returns the number of bytes written. Use get_serialized_size_bytes() to size the buffer."
+    )
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes) { return SK::deserialize(bytes.c_str(), bytes.size()); },
-        nb::arg("bytes"),
-        "Deserializes the sketch from a bytes object."
+        [](nb::handle bytes, size_t offset, std::optional<size_t> length) {
+          datasketches::py_buffer buffer(bytes, offset, length);
+          nb::gil_scoped_release release;
+          return SK::deserialize(buffer.data(), buffer.size());
+        },
+        nb::arg("bytes"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Deserializes the sketch from a bytes-like object, optionally a slice of it given by offset and length."
+    )
+    .def(
+        "merge_serialized",
+        [](SK& sk, nb::handle buffers, unsigned num_threads) {
+          auto views = datasketches::get_buffers(buffers);
+          std::optional<SK> result;
+          {
+            nb::gil_scoped_release release;
+            result = datasketches::tree_reduce<SK>(views.size(), num_threads,
+              [&views](std::optional<SK>& acc, size_t i) {
+                auto other = SK::deserialize(views[i].data(), views[i].size());
+                if (acc) acc->merge(std::move(other));
+                else acc.emplace(std::move(other));
+              },
+              [](SK& acc, SK&& other) { acc.merge(std::move(other)); }
+            );
+          }
+          if (result) sk.merge(std::move(*result));
+        },
+        nb::arg("buffers"), nb::arg("num_threads")=1,
+        "Deserializes each of the given serialized sketches and merges them into this one, without "
+        "creating intermediate Python objects. With num_threads > 1 the inputs are split across threads "
+        "and the partial results combined by tree reduction; 0 uses one thread per core.\n\n"
+        ":param buffers: serialized sketches\n:type buffers: list of bytes-like objects\n"
+        ":param num_threads: the number of threads to use. Default 1\n:type num_threads: int, optional"
     );
 }
 
@@ -59,47 +133,237 @@ void add_serialization(nb::class_<SK>& clazz) {
 template<typename T, typename SK, typename std::enable_if<!std::is_arithmetic<T>::value && !std::is_same<std::string, T>::value, bool>::type = 0>
 void add_serialization(nb::class_<SK>& clazz) {
   clazz.def(
+        "get_serialized_size_bytes",
+        [](const SK& sk, datasketches::py_object_serde& serde) { return sk.get_serialized_size_bytes(serde); },
+        nb::arg("serde"),
+        "Returns the size of the sketch serialized using the provided serde, in bytes"
+    )
+    .def(
         "serialize",
         [](const SK& sk, datasketches::py_object_serde& serde) {
-          auto bytes = sk.serialize(0, serde);
-          return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+          return datasketches::serialize_to_bytes(sk.get_serialized_size_bytes(serde), [&sk, &serde](std::ostream& os) {
+            sk.serialize(os, serde);
+          });
         }, nb::arg("serde"),
         "Serializes the sketch into a bytes object using the provided serde."
     )
+    .def(
+        "serialize_into",
+        [](const SK& sk, nb::handle buffer, datasketches::py_object_serde& serde, size_t offset) {
+          return datasketches::serialize_into(buffer, offset, sk.get_serialized_size_bytes(serde), [&sk, &serde](std::ostream& os) {
+            sk.serialize(os, serde);
+          });
+        },
+        nb::arg("buffer"), nb::arg("serde"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset "
+        "and using the provided serde. Returns the number of bytes written."
+    )
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes, datasketches::py_object_serde& serde) {
-            return SK::deserialize(bytes.c_str(), bytes.size(), serde);
-        }, nb::arg("bytes"), nb::arg("serde"),
-        "Deserializes the sketch from a bytes object using the provided serde."
+        [](nb::handle bytes, datasketches::py_object_serde& serde, size_t offset, std::optional<size_t> length) {
+            datasketches::py_buffer buffer(bytes, offset, length);
+            return SK::deserialize(buffer.data(), buffer.size(), serde);
+        }, nb::arg("bytes"), nb::arg("serde"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Deserializes the sketch from a bytes-like object, optionally a slice of it given by offset and length, "
+        "using the provided serde."
     );
 }
 
 // Vector Updates
 // * Only allowed for POD types based on numpy restriction, which
 //   is equivalent to both std::is_trivial and std::is_standard_layout.
-// * Nothing is added to types that are not PODs.
+// * std::string items are read from batches of strings instead.
+// * Nothing is added to other types that are not PODs.
+// make_empty(sk) returns a new empty sketch configured like sk, into which
+// a share of the array is fed when the update is spread over threads.
 // POD type
-template<typename T, typename SK, typename std::enable_if<std::is_trivial<T>::value && std::is_standard_layout<T>::value, bool>::type = 0>
-void add_vector_update(nb::class_<SK>& clazz) {
+template<typename T, typename SK, typename F, typename std::enable_if<std::is_trivial<T>::value && std::is_standard_layout<T>::value, bool>::type = 0>
+void add_vector_update(nb::class_<SK>& clazz, F make_empty) {
   clazz.def(
     "update",
-    [](SK& sk, nb::ndarray<T> items) {
+    [make_empty](SK& sk, nb::ndarray<T> items, unsigned num_threads) {
       if (items.ndim() != 1) {
         throw std::invalid_argument("input data must have only one dimension. Found: "
           + std::to_string(items.ndim()));
       }
       auto v = items.template view<T, nb::ndim<1>>();
-      for (uint32_t i = 0; i < v.shape(0); ++i) sk.update(v(i));
+      const size_t n = v.shape(0);
+      // a few chunks per thread even out the load, but small arrays are not worth splitting
+      const size_t min_chunk_size = 1 << 16;
+      const unsigned threads = datasketches::resolve_num_threads(num_threads);
+      const size_t num_chunks = threads == 1 ? 1 : std::min<size_t>(4 * threads,
+        (n + min_chunk_size - 1) / min_chunk_size);
+      if (num_chunks <= 1) {
+        for (size_t i = 0; i < n; ++i) sk.update(v(i));
+        return;
+      }
+      // the shares are summarized into new sketches without the GIL, then merged into this one with it
+      const SK empty = make_empty(sk);
+      const size_t chunk_size = (n + num_chunks - 1) / num_chunks;
+      std::optional<SK> result;
+      {
+        nb::gil_scoped_release release;
+        result = datasketches::tree_reduce<SK>(num_chunks, num_threads,
+          [&](std::optional<SK>& acc, size_t c) {
+            if (!acc) acc.emplace(empty);
+            const size_t end = std::min(n, (c + 1) * chunk_size);
+            for (size_t i = c * chunk_size; i < end; ++i) acc->update(v(i));
+          },
+          [](SK& acc, SK&& other) { acc.merge(std::move(other)); }
+        );
+      }
+      if (result) sk.merge(std::move(*result));
+    },
+    nb::arg("array"), nb::kw_only(), nb::arg("num_threads")=1,
+    "Updates the sketch with the values in the given array. With num_threads > 1 a large array is split "
+    "into chunks, each thread summarizes its chunks into a sketch of its own, and those are merged into "
+    "this one, so the usual merge error bounds apply; 0 uses one thread per core.\n\n"
+    ":param array: the values to add\n:type array: numpy array\n"
+    ":param num_threads: the number of threads to use. Default 1\n:type num_threads: int, optional"
+  );
+}
+
+// std::string
+template<typename T, typename SK, typename F, typename std::enable_if<std::is_same<std::string, T>::value, bool>::type = 0>
+void add_vector_update(nb::class_<SK>& clazz, F) {
+  clazz.def(
+    "update_strings",
+    [](SK& sk, nb::handle items) {
+      datasketches::for_each_string(items, [&sk](const char* data, size_t length) {
+        sk.update(std::string(data, length));
+      });
+    },
+    nb::arg("items"),
+    "Updates the sketch with each string in the given numpy array of dtype S, U or object, "
+    "or in a sequence of str or bytes. None elements are skipped."
+  )
+  .def(
+    "update_strings_from_buffers",
+    [](SK& sk, nb::handle offsets, nb::handle data) {
+      datasketches::for_each_string(offsets, data, [&sk](const char* chars, size_t length) {
+        sk.update(std::string(chars, length));
+      });
+    },
+    nb::arg("offsets"), nb::arg("data"),
+    "Updates the sketch with each string of a variable-width layout, such as the buffers of an "
+    "Apache Arrow utf8 array, where string i is data[offsets[i]:offsets[i+1]].\n\n"
+    ":param offsets: n + 1 positions into data\n:type offsets: numpy array of int32 or int64\n"
+    ":param data: the concatenated string bytes\n:type data: any object supporting the buffer protocol"
+  );
+}
+
+// other non-POD types
+template<typename T, typename SK, typename F, typename std::enable_if<(!std::is_trivial<T>::value || !std::is_standard_layout<T>::value)
+  && !std::is_same<std::string, T>::value, bool>::type = 0>
+void add_vector_update(nb::class_<SK>& clazz, F) {
+  unused(clazz);
+}
+
+// Vector queries
+// numpy arrays of ranks or values are read in place and the results
+// returned as new numpy arrays. The sketch is read with the GIL held.
+// These overloads must be added before those taking lists, which also accept arrays.
+template<typename T, typename SK, typename std::enable_if<std::is_arithmetic<T>::value, bool>::type = 0>
+void add_vector_queries(nb::class_<SK>& clazz) {
+  using namespace datasketches;
+  clazz.def(
+    "get_quantiles",
+    [](const SK& sk, nb::ndarray<const double, nb::ndim<1>, nb::device::cpu> ranks, bool inclusive) {
+      prepare_sorted_view<T>(sk);
+      const double* in = ranks.data();
+      const int64_t stride = ranks.stride(0);
+      const size_t n = sk.is_empty() ? 0 : ranks.shape(0);
+      auto quantiles = make_numpy_array<T>(n);
+      T* out = quantiles.data();
+      for (size_t i = 0; i < n; ++i) out[i] = sk.get_quantile(in[i * stride], inclusive);
+      return quantiles;
+    },
+    nb::arg("ranks"), nb::arg("inclusive")=false,
+    "Returns a numpy array with the quantile for each normalized rank in the given numpy array.\n"
+    "If the sketch is empty this returns an empty array, as the list version does.\n"
+    ":return: one quantile per rank\n:rtype: numpy.ndarray of the sketch's item type"
+  )
+  .def(
+    "get_ranks",
+    [](const SK& sk, nb::ndarray<const T, nb::ndim<1>, nb::device::cpu> values, bool inclusive) {
+      prepare_sorted_view<T>(sk);
+      const T* in = values.data();
+      const int64_t stride = values.stride(0);
+      const size_t n = sk.is_empty() ? 0 : values.shape(0);
+      auto ranks = make_numpy_array<double>(n);
+      double* out = ranks.data();
+      for (size_t i = 0; i < n; ++i) out[i] = sk.get_rank(in[i * stride], inclusive);
+      return ranks;
+    },
+    nb::arg("values"), nb::arg("inclusive")=false,
+    "Returns a numpy array with the normalized rank of each value in the given numpy array, "
+    "as get_rank() would for each value separately.\n"
+    "If the sketch is empty this returns an empty array.\n"
+    ":return: one normalized rank per value\n:rtype: numpy.ndarray of float64"
+  )
+  .def(
+    "get_pmf",
+    [](const SK& sk, nb::ndarray<const T, nb::ndim<1>, nb::c_contig, nb::device::cpu> split_points, bool inclusive) {
+      prepare_sorted_view<T>(sk);
+      const T* points = split_points.data();
+      const size_t num_points = split_points.shape(0);
+      // like the list version, this throws if the sketch is empty
+      const auto result = sk.get_PMF(points, static_cast<uint32_t>(num_points), inclusive);
+      auto pmf = make_numpy_array<double>(result.size());
+      std::copy(result.begin(), result.end(), pmf.data());
+      return pmf;
+    },
+    nb::arg("split_points"), nb::arg("inclusive")=false,
+    "Returns a numpy array approximating the Probability Mass Function (PMF) of the input stream "
+    "for the split points in the given numpy array, as the list version of get_pmf() does.\n"
+    "If the sketch is empty this throws a RuntimeError, as the list version does.\n"
+    ":return: the m+1 masses for m split points\n:rtype: numpy.ndarray of float64"
+  )
+  .def(
+    "get_cdf",
+    [](const SK& sk, nb::ndarray<const T, nb::ndim<1>, nb::c_contig, nb::device::cpu> split_points, bool inclusive) {
+      prepare_sorted_view<T>(sk);
+      const T* points = split_points.data();
+      const size_t num_points = split_points.shape(0);
+      // like the list version, this throws if the sketch is empty
+      const auto result = sk.get_CDF(points, static_cast<uint32_t>(num_points), inclusive);
+      auto cdf = make_numpy_array<double>(result.size());
+      std::copy(result.begin(), result.end(), cdf.data());
+      return cdf;
+    },
+    nb::arg("split_points"), nb::arg("inclusive")=false,
+    "Returns a numpy array approximating the Cumulative Distribution Function (CDF) of the input stream "
+    "for the split points in the given numpy array, as the list version of get_cdf() does.\n"
+    "If the sketch is empty this throws a RuntimeError, as the list version does.\n"
+    ":return: the m+1 cumulative ranks for m split points\n:rtype: numpy.ndarray of float64"
+  );
+}
+
+// non-numeric types
+template<typename T, typename SK, typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type = 0>
+void add_vector_queries(nb::class_<SK>& clazz) {
+  unused(clazz);
+}
+
+// Sorted view
+// numeric types, whose views are bound in sorted_view_wrapper.cpp
+template<typename T, typename SK, typename std::enable_if<std::is_arithmetic<T>::value, bool>::type = 0>
+void add_sorted_view(nb::class_<SK>& clazz) {
+  clazz.def(
+    "sorted_view",
+    [](const SK& sk) {
+      prepare_sorted_view<T>(sk);
+      return sk.get_sorted_view();
     },
-    nb::arg("array"),
-    "Updates the sketch with the values in the given array"
+    "Returns a snapshot of the retained items in sorted order with their cumulative weights. "
+    "The snapshot answers repeated queries without rebuilding it, may be shared across threads "
+    "and does not change when the sketch is updated afterwards."
   );
 }
 
-// non-POD type
-template<typename T, typename SK, typename std::enable_if<!std::is_trivial<T>::value || !std::is_standard_layout<T>::value, bool>::type = 0>
-void add_vector_update(nb::class_<SK>& clazz) {
+// other types
+template<typename T, typename SK, typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type = 0>
+void add_sorted_view(nb::class_<SK>& clazz) {
   unused(clazz);
 }
 
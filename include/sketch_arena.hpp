@@ -0,0 +1,186 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef _SKETCH_ARENA_HPP_
+#define _SKETCH_ARENA_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/*
+  This header defines a memory arena shared by many small sketches,
+  and an allocator drawing from it. Sketches hold their items in a
+  few arrays each, so a large collection of them otherwise pays the
+  general-purpose allocator's per-allocation overhead many times over
+  and scatters its data across the heap.
+  Memory is carved out of large blocks. Freed allocations go to a free
+  list for their size and are reused, but blocks are only returned to
+  the system when the arena itself is destroyed, so a collection is
+  compacted by copying its sketches into a fresh arena.
+  The arena is thread-safe, so sketches sharing it may be updated from
+  different threads. A single mutex guards it, so allocations from those
+  threads are serialized.
+*/
+
+namespace datasketches {
+
+class sketch_arena {
+public:
+  static const size_t DEFAULT_BLOCK_SIZE = 1 << 20;
+
+  explicit sketch_arena(size_t block_size = DEFAULT_BLOCK_SIZE):
+  block_size_(block_size), cursor_(nullptr), remaining_(0), allocated_(0), reserved_(0) {}
+
+  sketch_arena(const sketch_arena&) = delete;
+  sketch_arena& operator=(const sketch_arena&) = delete;
+
+  void* allocate(size_t bytes) {
+    const size_t size = round_up(bytes);
+    // large allocations bypass the blocks
+    if (size > block_size_ / 4) {
+      void* ptr = ::operator new(size);
+      std::lock_guard<std::mutex> lock(mutex_);
+      allocated_ += size;
+      reserved_ += size;
+      return ptr;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocated_ += size;
+    auto it = free_lists_.find(size);
+    if (it != free_lists_.end() && !it->second.empty()) {
+      void* ptr = it->second.back();
+      it->second.pop_back();
+      return ptr;
+    }
+    if (size > remaining_) {
+      // the tail of the current block is left unused
+      blocks_.emplace_back(new char[block_size_]);
+      cursor_ = blocks_.back().get();
+      remaining_ = block_size_;
+      reserved_ += block_size_;
+    }
+    void* ptr = cursor_;
+    cursor_ += size;
+    remaining_ -= size;
+    return ptr;
+  }
+
+  void deallocate(void* ptr, size_t bytes) noexcept {
+    if (ptr == nullptr) return;
+    const size_t size = round_up(bytes);
+    if (size > block_size_ / 4) {
+      ::operator delete(ptr);
+      std::lock_guard<std::mutex> lock(mutex_);
+      allocated_ -= size;
+      reserved_ -= size;
+      return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    allocated_ -= size;
+    try {
+      free_lists_[size].push_back(ptr);
+    } catch (...) {
+      // without room to record it the allocation is simply not reused
+    }
+  }
+
+  // bytes handed out and not yet returned
+  size_t get_allocated_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return allocated_;
+  }
+
+  // bytes obtained from the system, including free space
+  size_t get_reserved_bytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reserved_;
+  }
+
+private:
+  // every allocation keeps the alignment of the blocks
+  static const size_t GRANULE = alignof(std::max_align_t);
+
+  static size_t round_up(size_t bytes) {
+    return bytes == 0 ? GRANULE : (bytes + GRANULE - 1) / GRANULE * GRANULE;
+  }
+
+  const size_t block_size_;
+  mutable std::mutex mutex_;
+  std::vector<std::unique_ptr<char[]>> blocks_;
+  char* cursor_;
+  size_t remaining_;
+  std::unordered_map<size_t, std::vector<void*>> free_lists_;
+  size_t allocated_;
+  size_t reserved_;
+};
+
+// A default-constructed allocator creates a new arena, which is shared
+// by its copies, including those rebound to other types.
+template<typename T>
+class arena_allocator {
+public:
+  using value_type = T;
+  using propagate_on_container_copy_assignment = std::true_type;
+  using propagate_on_container_move_assignment = std::true_type;
+  using propagate_on_container_swap = std::true_type;
+
+  arena_allocator(): arena_(std::make_shared<sketch_arena>()) {}
+  explicit arena_allocator(std::shared_ptr<sketch_arena> arena): arena_(std::move(arena)) {}
+
+  // there is no move constructor, so a moved-from allocator keeps its arena
+  arena_allocator(const arena_allocator& other) noexcept = default;
+  arena_allocator& operator=(const arena_allocator& other) noexcept = default;
+
+  template<typename U>
+  arena_allocator(const arena_allocator<U>& other) noexcept: arena_(other.get_arena()) {}
+
+  T* allocate(size_t n) {
+    return static_cast<T*>(arena_->allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* ptr, size_t n) noexcept {
+    arena_->deallocate(ptr, n * sizeof(T));
+  }
+
+  const std::shared_ptr<sketch_arena>& get_arena() const { return arena_; }
+
+  template<typename U>
+  bool operator==(const arena_allocator<U>& other) const { return arena_ == other.get_arena(); }
+
+  template<typename U>
+  bool operator!=(const arena_allocator<U>& other) const { return arena_ != other.get_arena(); }
+
+private:
+  std::shared_ptr<sketch_arena> arena_;
+};
+
+template<typename A>
+struct is_arena_allocator: std::false_type {};
+
+template<typename T>
+struct is_arena_allocator<arena_allocator<T>>: std::true_type {};
+
+}
+
+#endif // _SKETCH_ARENA_HPP_
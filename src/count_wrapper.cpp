@@ -22,6 +22,9 @@
 
 #include "count_min.hpp"
 #include "common_defs.hpp"
+#include "py_buffer.hpp"
+#include "py_output_buffer.hpp"
+#include "py_string_array.hpp"
 
 namespace nb = nanobind;
 
@@ -70,6 +73,31 @@ void bind_count_min_sketch(nb::module_ &m, const char* name) {
          "Updates the sketch with the given 64-bit integer value")
     .def("update", static_cast<void (count_min_sketch<W>::*)(const std::string&, W)>(&count_min_sketch<W>::update), nb::arg("item"), nb::arg("weight")=1.0,
          "Updates the sketch with the given string")
+    .def(
+        "update_strings",
+        [](count_min_sketch<W>& sk, nb::handle items, W weight) {
+          for_each_string(items, [&sk, weight](const char* data, size_t length) {
+            if (length > 0) sk.update(data, length, weight);
+          });
+        },
+        nb::arg("items"), nb::arg("weight")=1.0,
+        "Updates the sketch with each string in the given numpy array of dtype S, U or object, "
+        "or in a sequence of str or bytes, optionally applying the same weight to each. None elements are skipped."
+    )
+    .def(
+        "update_strings_from_buffers",
+        [](count_min_sketch<W>& sk, nb::handle offsets, nb::handle data, W weight) {
+          for_each_string(offsets, data, [&sk, weight](const char* chars, size_t length) {
+            if (length > 0) sk.update(chars, length, weight);
+          });
+        },
+        nb::arg("offsets"), nb::arg("data"), nb::arg("weight")=1.0,
+        "Updates the sketch with each string of a variable-width layout, such as the buffers of an "
+        "Apache Arrow utf8 array, where string i is data[offsets[i]:offsets[i+1]].\n\n"
+        ":param offsets: n + 1 positions into data\n:type offsets: numpy array of int32 or int64\n"
+        ":param data: the concatenated string bytes\n:type data: any object supporting the buffer protocol\n"
+        ":param weight: the weight applied to each string\n:type weight: float, optional"
+    )
     .def("get_estimate", static_cast<W (count_min_sketch<W>::*)(int64_t) const>(&count_min_sketch<W>::get_estimate), nb::arg("item"),
          "Returns an estimate of the frequency of the provided 64-bit integer value")
     .def("get_estimate", static_cast<W (count_min_sketch<W>::*)(const std::string&) const>(&count_min_sketch<W>::get_estimate), nb::arg("item"),
@@ -89,16 +117,29 @@ void bind_count_min_sketch(nb::module_ &m, const char* name) {
     .def(
         "serialize",
         [](const count_min_sketch<W>& sk) {
-          auto bytes = sk.serialize();
-          return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+          return serialize_to_bytes(sk.get_serialized_size_bytes(), [&sk](std::ostream& os) { sk.serialize(os); });
         },
         "Serializes the sketch into a bytes object"
     )
+    .def(
+        "serialize_into",
+        [](const count_min_sketch<W>& sk, nb::handle buffer, size_t offset) {
+          return serialize_into(buffer, offset, sk.get_serialized_size_bytes(), [&sk](std::ostream& os) { sk.serialize(os); });
+        },
+        nb::arg("buffer"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset. "
+        "Returns the number of bytes written."
+    )
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes) { return count_min_sketch<W>::deserialize(bytes.c_str(), bytes.size()); },
-        nb::arg("bytes"),
-        "Reads a bytes object and returns the corresponding count_min_sketch"
+        [](nb::handle bytes, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
+          nb::gil_scoped_release release;
+          return count_min_sketch<W>::deserialize(buffer.data(), buffer.size());
+        },
+        nb::arg("bytes"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+        "and returns the corresponding count_min_sketch"
     );
 }
 
@@ -24,13 +24,17 @@
 #include "cpc_union.hpp"
 #include "cpc_common.hpp"
 #include "common_defs.hpp"
+#include "parallel_reduce.hpp"
+#include "py_buffer.hpp"
+#include "py_output_buffer.hpp"
+#include "hash_vector_update.hpp"
 
 namespace nb = nanobind;
 
 void init_cpc(nb::module_ &m) {
   using namespace datasketches;
 
-  nb::class_<cpc_sketch>(m, "cpc_sketch")
+  auto cpc_class = nb::class_<cpc_sketch>(m, "cpc_sketch")
     .def(nb::init<uint8_t, uint64_t>(), nb::arg("lg_k")=cpc_constants::DEFAULT_LG_K, nb::arg("seed")=DEFAULT_SEED,
          "Creates a new CPC sketch\n\n"
          ":param lg_k: base 2 logarithm of the number of bins in the sketch\n"
@@ -67,12 +71,37 @@ void init_cpc(nb::module_ &m) {
         },
         "Serializes the sketch into a bytes object"
     )
+    .def(
+        "get_serialized_size_bytes",
+        [](const cpc_sketch& sk) {
+          return count_serialized_bytes([&sk](std::ostream& os) { sk.serialize(os); });
+        },
+        "Returns the size of the serialized sketch, in bytes. "
+        "The size depends on how well the sketch compresses, so this costs as much as serializing."
+    )
+    .def(
+        "serialize_into",
+        [](const cpc_sketch& sk, nb::handle buffer, size_t offset) {
+          const size_t size = count_serialized_bytes([&sk](std::ostream& os) { sk.serialize(os); });
+          return serialize_into(buffer, offset, size, [&sk](std::ostream& os) { sk.serialize(os); });
+        },
+        nb::arg("buffer"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset. "
+        "Returns the number of bytes written."
+    )
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes) { return cpc_sketch::deserialize(bytes.c_str(), bytes.size()); },
-        nb::arg("bytes"),
-        "Reads a bytes object and returns the corresponding cpc_sketch"
+        [](nb::handle bytes, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
+          nb::gil_scoped_release release;
+          return cpc_sketch::deserialize(buffer.data(), buffer.size());
+        },
+        nb::arg("bytes"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+        "and returns the corresponding cpc_sketch"
     );
+  add_hash_vector_updates(cpc_class);
+  add_string_vector_updates(cpc_class);
 
   nb::class_<cpc_union>(m, "cpc_union")
     .def(nb::init<uint8_t, uint64_t>(), nb::arg("lg_k"), nb::arg("seed")=DEFAULT_SEED)
@@ -80,5 +109,32 @@ void init_cpc(nb::module_ &m) {
          "Updates the union with the provided CPC sketch")
     .def("get_result", &cpc_union::get_result,
          "Returns a CPC sketch with the result of the union")
+    .def(
+        "update_serialized",
+        [](cpc_union& u, nb::handle buffers, unsigned num_threads, uint64_t seed) {
+          auto views = get_buffers(buffers);
+          std::optional<cpc_sketch> merged;
+          {
+            nb::gil_scoped_release release;
+            auto result = tree_reduce<cpc_union>(views.size(), num_threads,
+              [&views, seed](std::optional<cpc_union>& acc, size_t i) {
+                auto sk = cpc_sketch::deserialize(views[i].data(), views[i].size(), seed);
+                if (!acc) acc.emplace(sk.get_lg_k(), seed);
+                acc->update(std::move(sk));
+              },
+              [](cpc_union& acc, cpc_union&& other) { acc.update(other.get_result()); }
+            );
+            if (result) merged.emplace(result->get_result());
+          }
+          if (merged) u.update(std::move(*merged));
+        },
+        nb::arg("buffers"), nb::arg("num_threads")=1, nb::arg("seed")=DEFAULT_SEED,
+        "Deserializes each of the given serialized CPC sketches and updates the union with them, without "
+        "creating intermediate Python objects. With num_threads > 1 the inputs are split across threads "
+        "and the partial unions combined by tree reduction; 0 uses one thread per core.\n\n"
+        ":param buffers: serialized sketches\n:type buffers: list of bytes-like objects\n"
+        ":param num_threads: the number of threads to use. Default 1\n:type num_threads: int, optional\n"
+        ":param seed: the seed used when hashing values. Must match all sketch seeds\n:type seed: int, optional"
+    )
     ;
 }
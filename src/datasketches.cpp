@@ -43,7 +43,9 @@ void init_tdigest(nb::module_& m);
 void init_vector_of_kll(nb::module_& m);
 
 // supporting objects
+void init_sorted_view(nb::module_& m);
 void init_kolmogorov_smirnov(nb::module_& m);
+void init_parallel_merge(nb::module_& m);
 void init_serde(nb::module_& m);
 
 NB_MODULE(_datasketches, m) {
@@ -74,6 +76,8 @@ NB_MODULE(_datasketches, m) {
   init_tdigest(m);
   init_vector_of_kll(m);
 
+  init_sorted_view(m);
   init_kolmogorov_smirnov(m);
+  init_parallel_merge(m);
   init_serde(m);
 }
@@ -29,6 +29,8 @@
 
 #include <numpy/arrayobject.h>
 
+#include "py_buffer.hpp"
+#include "py_output_buffer.hpp"
 #include "kernel_function.hpp"
 #include "density_sketch.hpp"
 
@@ -86,14 +88,31 @@ void bind_density_sketch(nb::module_ &m, const char* name) {
         },
         "Serializes the sketch into a bytes object"
     )
+    .def("get_serialized_size_bytes",
+        [](const density_sketch<T, K>& sk) {
+          return count_serialized_bytes([&sk](std::ostream& os) { sk.serialize(os); });
+        },
+        "Computes the size in bytes needed to serialize the current sketch"
+    )
+    .def("serialize_into",
+        [](const density_sketch<T, K>& sk, nb::handle buffer, size_t offset) {
+          const size_t size = count_serialized_bytes([&sk](std::ostream& os) { sk.serialize(os); });
+          return serialize_into(buffer, offset, size, [&sk](std::ostream& os) { sk.serialize(os); });
+        },
+        nb::arg("buffer"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset. "
+        "Returns the number of bytes written."
+    )
     .def_static(
         "deserialize",
-          [](const nb::bytes& bytes, kernel_function* kernel) {
+          [](nb::handle bytes, kernel_function* kernel, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
           K holder(kernel);
-          return density_sketch<T, K>::deserialize(bytes.c_str(), bytes.size(), holder);
+          return density_sketch<T, K>::deserialize(buffer.data(), buffer.size(), holder);
         },
-        nb::arg("bytes"), nb::arg("kernel"),
-        "Reads a bytes object and returns the corresponding density_sketch"
+        nb::arg("bytes"), nb::arg("kernel"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+        "and returns the corresponding density_sketch"
     );
 }
 
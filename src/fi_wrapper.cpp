@@ -18,8 +18,12 @@
  */
 
 
+#include "parallel_reduce.hpp"
+#include "py_buffer.hpp"
+#include "py_output_buffer.hpp"
 #include "py_serde.hpp"
 #include "py_object_ostream.hpp"
+#include "py_string_array.hpp"
 #include "frequent_items_sketch.hpp"
 
 #include <nanobind/nanobind.h>
@@ -32,6 +36,13 @@
 namespace pb = nanobind;
 
 // forward declarations
+template<typename T, typename W, typename H, typename E, typename std::enable_if<std::is_same<std::string, T>::value, bool>::type = 0>
+void add_string_vector_updates(nb::class_<datasketches::frequent_items_sketch<T, W, H, E>>& clazz);
+
+template<typename T, typename W, typename H, typename E, typename std::enable_if<!std::is_same<std::string, T>::value, bool>::type = 0>
+void add_string_vector_updates(nb::class_<datasketches::frequent_items_sketch<T, W, H, E>>& clazz);
+
+
 // std::string and arithmetic types, where we don't need a separate serde
 template<typename T, typename W, typename H, typename E, typename std::enable_if<std::is_arithmetic<T>::value || std::is_same<std::string, T>::value, bool>::type = 0>
 void add_serialization(nb::class_<datasketches::frequent_items_sketch<T, W, H, E>>& clazz);
@@ -110,6 +121,40 @@ void bind_fi_sketch(nb::module_ &m, const char* name) {
     // serialization may need a caller-provided serde depending on the sketch type, so
     // we use a separate method to handle that appropriately based on type T.
     add_serialization(fi_class);
+    add_string_vector_updates(fi_class);
+}
+
+// std::string items may be ingested in batches
+template<typename T, typename W, typename H, typename E, typename std::enable_if<std::is_same<std::string, T>::value, bool>::type>
+void add_string_vector_updates(nb::class_<datasketches::frequent_items_sketch<T, W, H, E>>& clazz) {
+    using namespace datasketches;
+    clazz.def(
+        "update_strings",
+        [](frequent_items_sketch<T, W, H, E>& sk, nb::handle items, uint64_t weight) {
+          for_each_string(items, [&sk, weight](const char* data, size_t length) { sk.update(std::string(data, length), weight); });
+        },
+        nb::arg("items"), nb::arg("weight")=1,
+        "Updates the sketch with each string in the given numpy array of dtype S, U or object, "
+        "or in a sequence of str or bytes, optionally applying the same weight to each. None elements are skipped."
+    )
+    .def(
+        "update_strings_from_buffers",
+        [](frequent_items_sketch<T, W, H, E>& sk, nb::handle offsets, nb::handle data, uint64_t weight) {
+          for_each_string(offsets, data, [&sk, weight](const char* chars, size_t length) { sk.update(std::string(chars, length), weight); });
+        },
+        nb::arg("offsets"), nb::arg("data"), nb::arg("weight")=1,
+        "Updates the sketch with each string of a variable-width layout, such as the buffers of an "
+        "Apache Arrow utf8 array, where string i is data[offsets[i]:offsets[i+1]].\n\n"
+        ":param offsets: n + 1 positions into data\n:type offsets: numpy array of int32 or int64\n"
+        ":param data: the concatenated string bytes\n:type data: any object supporting the buffer protocol\n"
+        ":param weight: the weight applied to each string\n:type weight: int, optional"
+    );
+}
+
+// batch ingestion is not supported for other types
+template<typename T, typename W, typename H, typename E, typename std::enable_if<!std::is_same<std::string, T>::value, bool>::type>
+void add_string_vector_updates(nb::class_<datasketches::frequent_items_sketch<T, W, H, E>>& clazz) {
+    unused(clazz);
 }
 
 // std::string or arithmetic types, for which we have a built-in serde
@@ -124,16 +169,55 @@ void add_serialization(nb::class_<datasketches::frequent_items_sketch<T, W, H, E
     .def(
         "serialize",
         [](const frequent_items_sketch<T, W, H, E>& sk) {
-          auto bytes = sk.serialize();
-          return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+          return serialize_to_bytes(sk.get_serialized_size_bytes(), [&sk](std::ostream& os) { sk.serialize(os); });
         },
         "Serializes the sketch into a bytes object."
     )
+    .def(
+        "serialize_into",
+        [](const frequent_items_sketch<T, W, H, E>& sk, nb::handle buffer, size_t offset) {
+          return serialize_into(buffer, offset, sk.get_serialized_size_bytes(), [&sk](std::ostream& os) { sk.serialize(os); });
+        },
+        nb::arg("buffer"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset. "
+        "Returns the number of bytes written."
+    )
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes) { return frequent_items_sketch<T, W, H, E>::deserialize(bytes.c_str(), bytes.size()); },
-        nb::arg("bytes"),
-        "Reads a bytes object and returns the corresponding frequent_strings_sketch."
+        [](nb::handle bytes, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
+          nb::gil_scoped_release release;
+          return frequent_items_sketch<T, W, H, E>::deserialize(buffer.data(), buffer.size());
+        },
+        nb::arg("bytes"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+        "and returns the corresponding frequent_strings_sketch."
+    )
+    .def(
+        "merge_serialized",
+        [](frequent_items_sketch<T, W, H, E>& sk, nb::handle buffers, unsigned num_threads) {
+          using SK = frequent_items_sketch<T, W, H, E>;
+          auto views = get_buffers(buffers);
+          std::optional<SK> result;
+          {
+            nb::gil_scoped_release release;
+            result = tree_reduce<SK>(views.size(), num_threads,
+              [&views](std::optional<SK>& acc, size_t i) {
+                auto other = SK::deserialize(views[i].data(), views[i].size());
+                if (acc) acc->merge(std::move(other));
+                else acc.emplace(std::move(other));
+              },
+              [](SK& acc, SK&& other) { acc.merge(std::move(other)); }
+            );
+          }
+          if (result) sk.merge(std::move(*result));
+        },
+        nb::arg("buffers"), nb::arg("num_threads")=1,
+        "Deserializes each of the given serialized sketches and merges them into this one, without "
+        "creating intermediate Python objects. With num_threads > 1 the inputs are split across threads "
+        "and the partial results combined by tree reduction; 0 uses one thread per core.\n\n"
+        ":param buffers: serialized sketches\n:type buffers: list of bytes-like objects\n"
+        ":param num_threads: the number of threads to use. Default 1\n:type num_threads: int, optional"
     );
 }
 
@@ -150,17 +234,31 @@ void add_serialization(nb::class_<datasketches::frequent_items_sketch<T, W, H, E
     .def(
         "serialize",
         [](const frequent_items_sketch<T, W, H, E>& sk, py_object_serde& serde) {
-          auto bytes = sk.serialize(0, serde);
-          return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+          return serialize_to_bytes(sk.get_serialized_size_bytes(serde), [&sk, &serde](std::ostream& os) {
+            sk.serialize(os, serde);
+          });
         }, nb::arg("serde"),
         "Serializes the sketch into a bytes object using the provided serde."
     )
+    .def(
+        "serialize_into",
+        [](const frequent_items_sketch<T, W, H, E>& sk, nb::handle buffer, py_object_serde& serde, size_t offset) {
+          return serialize_into(buffer, offset, sk.get_serialized_size_bytes(serde), [&sk, &serde](std::ostream& os) {
+            sk.serialize(os, serde);
+          });
+        },
+        nb::arg("buffer"), nb::arg("serde"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset "
+        "and using the provided serde. Returns the number of bytes written."
+    )
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes, py_object_serde& serde) {
-          return frequent_items_sketch<T, W, H, E>::deserialize(bytes.c_str(), bytes.size(), serde);
-        }, nb::arg("bytes"), nb::arg("serde"),
-        "Reads a bytes object using the provided serde and returns the corresponding frequent_strings_sketch."
+        [](nb::handle bytes, py_object_serde& serde, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
+          return frequent_items_sketch<T, W, H, E>::deserialize(buffer.data(), buffer.size(), serde);
+        }, nb::arg("bytes"), nb::arg("serde"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+        "using the provided serde and returns the corresponding frequent_items_sketch."
     );
 }
 
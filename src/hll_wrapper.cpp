@@ -21,6 +21,10 @@
 #include <nanobind/stl/string.h>
 
 #include "hll.hpp"
+#include "parallel_reduce.hpp"
+#include "py_buffer.hpp"
+#include "py_output_buffer.hpp"
+#include "hash_vector_update.hpp"
 
 namespace nb = nanobind;
 
@@ -33,7 +37,7 @@ void init_hll(nb::module_ &m) {
     .value("HLL_8", HLL_8)
     .export_values();
 
-  nb::class_<hll_sketch>(m, "hll_sketch")
+  auto hll_class = nb::class_<hll_sketch>(m, "hll_sketch")
     .def(nb::init<uint8_t, target_hll_type, bool>(), nb::arg("lg_k"), nb::arg("tgt_type")=HLL_8, nb::arg("start_max_size")=false,
          "Constructs a new HLL sketch\n\n"
          ":param lg_config_k: A full sketch can hold 2^lg_config_k rows. Must be between 7 and 21, inclusive,\n"
@@ -82,27 +86,53 @@ void init_hll(nb::module_ &m) {
     .def(
         "serialize_compact",
         [](const hll_sketch& sk) {
-          auto bytes = sk.serialize_compact();
-          return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+          return serialize_to_bytes(sk.get_compact_serialization_bytes(), [&sk](std::ostream& os) { sk.serialize_compact(os); });
         },
         "Serializes the sketch into a bytes object, compressing the exception table if HLL_4"
     )
     .def(
         "serialize_updatable",
         [](const hll_sketch& sk) {
-          auto bytes = sk.serialize_updatable();
-          return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+          return serialize_to_bytes(sk.get_updatable_serialization_bytes(), [&sk](std::ostream& os) { sk.serialize_updatable(os); });
         },
         "Serializes the sketch into a bytes object"
     )
+    .def(
+        "get_serialized_size_bytes",
+        [](const hll_sketch& sk, bool compact) {
+          return compact ? sk.get_compact_serialization_bytes() : sk.get_updatable_serialization_bytes();
+        },
+        nb::arg("compact")=true,
+        "Returns the size of the serialized sketch, in bytes, in either the compact or the updatable form"
+    )
+    .def(
+        "serialize_into",
+        [](const hll_sketch& sk, nb::handle buffer, size_t offset, bool compact) {
+          const size_t size = compact ? sk.get_compact_serialization_bytes() : sk.get_updatable_serialization_bytes();
+          return serialize_into(buffer, offset, size, [&sk, compact](std::ostream& os) {
+            if (compact) sk.serialize_compact(os);
+            else sk.serialize_updatable(os);
+          });
+        },
+        nb::arg("buffer"), nb::arg("offset")=0, nb::arg("compact")=true,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset, "
+        "in either the compact or the updatable form. Returns the number of bytes written."
+    )
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes) { return hll_sketch::deserialize(bytes.c_str(), bytes.size()); },
-        nb::arg("bytes"),
-        "Reads a bytes object and returns the corresponding hll_sketch"
+        [](nb::handle bytes, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
+          nb::gil_scoped_release release;
+          return hll_sketch::deserialize(buffer.data(), buffer.size());
+        },
+        nb::arg("bytes"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+        "and returns the corresponding hll_sketch"
     );
+  add_hash_vector_updates(hll_class);
+  add_string_vector_updates(hll_class);
 
-  nb::class_<hll_union>(m, "hll_union")
+  auto union_class = nb::class_<hll_union>(m, "hll_union")
     .def(nb::init<uint8_t>(), nb::arg("lg_max_k"),
          "Construct an hll_union object if the given size.\n\n"
          ":param lg_max_k: The maximum size, in log2, of k. Must be between 7 and 21, inclusive.\n"
@@ -129,8 +159,37 @@ void init_hll(nb::module_ &m) {
          "Updates the union with the given floating point value")
     .def<void (hll_union::*)(const std::string&)>("update", &hll_union::update, nb::arg("datum"),
          "Updates the union with the given string value")
+    .def(
+        "update_serialized",
+        [](hll_union& u, nb::handle buffers, unsigned num_threads) {
+          auto views = get_buffers(buffers);
+          const uint8_t lg_k = u.get_lg_config_k();
+          std::optional<hll_sketch> merged;
+          {
+            nb::gil_scoped_release release;
+            // unions at the current lg_k lose nothing, as registers combine by max
+            auto result = tree_reduce<hll_union>(views.size(), num_threads,
+              [&views, lg_k](std::optional<hll_union>& acc, size_t i) {
+                if (!acc) acc.emplace(lg_k);
+                acc->update(hll_sketch::deserialize(views[i].data(), views[i].size()));
+              },
+              [](hll_union& acc, hll_union&& other) { acc.update(other.get_result(HLL_8)); }
+            );
+            if (result) merged.emplace(result->get_result(HLL_8));
+          }
+          if (merged) u.update(std::move(*merged));
+        },
+        nb::arg("buffers"), nb::arg("num_threads")=1,
+        "Deserializes each of the given serialized HLL sketches and updates the union with them, without "
+        "creating intermediate Python objects. With num_threads > 1 the inputs are split across threads "
+        "and the partial unions combined by tree reduction; 0 uses one thread per core.\n\n"
+        ":param buffers: serialized sketches\n:type buffers: list of bytes-like objects\n"
+        ":param num_threads: the number of threads to use. Default 1\n:type num_threads: int, optional"
+    )
     .def_static("get_rel_err", &hll_union::get_rel_err,
          nb::arg("upper_bound"), nb::arg("unioned"), nb::arg("lg_k"), nb::arg("num_std_devs"),
          "Returns the a priori relative error bound for the given parameters")
     ;
+  add_hash_vector_updates(union_class);
+  add_string_vector_updates(union_class);
 }
@@ -17,26 +17,101 @@
  * under the License.
  */
 
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <nanobind/nanobind.h>
 #include <nanobind/make_iterator.h>
+#include <nanobind/ndarray.h>
 #include <nanobind/stl/string.h>
 #include <nanobind/stl/vector.h>
 
 #include "py_object_lt.hpp"
 #include "py_object_ostream.hpp"
+#include "py_keyed_item.hpp"
+#include "gil_release.hpp"
+#include "py_output_buffer.hpp"
 #include "quantile_conditional.hpp"
 
 #include "kll_sketch.hpp"
 
 namespace nb = nanobind;
 
+// The KLL sketch has no weighted update, so each weight is decomposed into
+// powers of two. Items are fed to a temporary sketch from the highest bit
+// down, and before moving to the next lower bit everything accumulated so
+// far has its weight doubled by merging in a copy. The cost is proportional
+// to the number of items times the number of bits in the largest weight.
+// The temporary sketch is returned so that the caller can merge it with the GIL held.
+template<typename T, typename C>
+datasketches::kll_sketch<T, C> weighted_sketch(uint16_t k, const T* values, int64_t values_stride,
+                                               const int64_t* weights, int64_t weights_stride, size_t n) {
+  int max_bit = -1;
+  for (size_t i = 0; i < n; ++i) {
+    const int64_t weight = weights[i * weights_stride];
+    if (weight < 0) throw std::invalid_argument("weights must be non-negative. Found: " + std::to_string(weight));
+    while (max_bit < 62 && (weight >> (max_bit + 1)) != 0) ++max_bit;
+  }
+
+  datasketches::kll_sketch<T, C> acc(k);
+  for (int bit = max_bit; bit >= 0; --bit) {
+    if (!acc.is_empty()) {
+      datasketches::kll_sketch<T, C> copy(acc);
+      acc.merge(std::move(copy));
+    }
+    for (size_t i = 0; i < n; ++i) {
+      if ((weights[i * weights_stride] >> bit) & 1) acc.update(values[i * values_stride]);
+    }
+  }
+  return acc;
+}
+
+template<typename T, typename C, typename std::enable_if<std::is_arithmetic<T>::value, bool>::type = 0>
+void add_weighted_update(nb::class_<datasketches::kll_sketch<T, C>>& clazz) {
+  clazz.def(
+    "update",
+    [](datasketches::kll_sketch<T, C>& sk, nb::ndarray<const T, nb::ndim<1>, nb::device::cpu> values,
+       nb::ndarray<const int64_t, nb::ndim<1>, nb::device::cpu> weights) {
+      if (values.shape(0) != weights.shape(0)) {
+        throw std::invalid_argument("values and weights must have the same length. Found: "
+          + std::to_string(values.shape(0)) + " and " + std::to_string(weights.shape(0)));
+      }
+      const uint16_t k = sk.get_k();
+      std::optional<datasketches::kll_sketch<T, C>> acc;
+      {
+        nb::gil_scoped_release release;
+        acc.emplace(weighted_sketch<T, C>(k, values.data(), values.stride(0), weights.data(), weights.stride(0), values.shape(0)));
+      }
+      if (!acc->is_empty()) sk.merge(std::move(*acc));
+    },
+    nb::arg("values"), nb::arg("weights"),
+    "Updates the sketch with each value in the given array, counted the number of times given by the "
+    "corresponding entry of the weights array, as from the buckets of a histogram. "
+    "The cost depends on the number of values and the size of the largest weight, not on the total weight.\n\n"
+    ":param values: the values\n:type values: numpy array\n"
+    ":param weights: the non-negative integer weight of each value\n:type weights: numpy array of int64"
+  );
+}
+
+template<typename T, typename C, typename std::enable_if<!std::is_arithmetic<T>::value, bool>::type = 0>
+void add_weighted_update(nb::class_<datasketches::kll_sketch<T, C>>& clazz) {
+  datasketches::unused(clazz);
+}
+
 template<typename T, typename C>
 void bind_kll_sketch(nb::module_ &m, const char* name) {
   using namespace datasketches;
 
-  auto kll_class = nb::class_<kll_sketch<T, C>>(m, name)
+  auto kll_class = nb::class_<kll_sketch<T, C>>(m, name);
+  // numpy overloads come first, as the list versions would also accept arrays
+  add_vector_queries<T>(kll_class);
+
+  kll_class
     .def(nb::init<uint16_t>(), nb::arg("k")=kll_constants::DEFAULT_K,
          "Creates a KLL sketch instance with the given value of k.\n\n"
          ":param k: Controls the size/accuracy trade-off of the sketch. Default is 200.\n"
@@ -65,7 +140,12 @@ void bind_kll_sketch(nb::module_ &m, const char* name) {
         "Returns the minimum value from the stream. If empty, kll_floats_sketch returns nan; kll_ints_sketch throws a RuntimeError")
     .def("get_max_value", &kll_sketch<T, C>::get_max_item,
         "Returns the maximum value from the stream. If empty, kll_floats_sketch returns nan; kll_ints_sketch throws a RuntimeError")
-    .def("get_quantile", &kll_sketch<T, C>::get_quantile, nb::arg("rank"), nb::arg("inclusive")=false,
+    .def("get_quantile",
+        [](const kll_sketch<T, C>& sk, double rank, bool inclusive) {
+          prepare_sorted_view<T>(sk);
+          return sk.get_quantile(rank, inclusive);
+        },
+        nb::arg("rank"), nb::arg("inclusive")=false,
         "Returns an approximation to the data value "
         "associated with the given normalized rank in a hypothetical sorted "
         "version of the input stream so far.\n"
@@ -74,6 +154,7 @@ void bind_kll_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_quantiles",
         [](const kll_sketch<T, C>& sk, const std::vector<double>& ranks, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           std::vector<T> quantiles;
           if (!sk.is_empty()) {
             quantiles.reserve(ranks.size());
@@ -86,7 +167,12 @@ void bind_kll_sketch(nb::module_ &m, const char* name) {
         "normalized rank separately.\n"
         "If the sketch is empty this returns an empty vector."
     )
-    .def("get_rank", &kll_sketch<T, C>::get_rank, nb::arg("value"), nb::arg("inclusive")=false,
+    .def("get_rank",
+        [](const kll_sketch<T, C>& sk, const T& value, bool inclusive) {
+          prepare_sorted_view<T>(sk);
+          return sk.get_rank(value, inclusive);
+        },
+        nb::arg("value"), nb::arg("inclusive")=false,
          "Returns an approximation to the normalized rank of the given value from 0 to 1, inclusive.\n"
          "The resulting approximation has a probabilistic guarantee that can be obtained from the "
          "get_normalized_rank_error(False) function.\n"
@@ -96,6 +182,7 @@ void bind_kll_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_pmf",
         [](const kll_sketch<T, C>& sk, const std::vector<T>& split_points, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           return sk.get_PMF(split_points.data(), split_points.size(), inclusive);
         },
         nb::arg("split_points"), nb::arg("inclusive")=false,
@@ -116,6 +203,7 @@ void bind_kll_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_cdf",
         [](const kll_sketch<T, C>& sk, const std::vector<T>& split_points, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           return sk.get_CDF(split_points.data(), split_points.size(), inclusive);
         },
         nb::arg("split_points"), nb::arg("inclusive")=false,
@@ -162,12 +250,238 @@ void bind_kll_sketch(nb::module_ &m, const char* name) {
     ;
 
     add_serialization<T>(kll_class);
-    add_vector_update<T>(kll_class);
+    add_vector_update<T>(kll_class, [](const kll_sketch<T, C>& sk) {
+      return kll_sketch<T, C>(sk.get_k(), sk.get_comparator());
+    });
+    add_weighted_update(kll_class);
+    add_sorted_view<T>(kll_class);
+}
+
+// Items are Python objects, so unlike the other variants the GIL is held throughout
+void bind_kll_keyed_items_sketch(nb::module_ &m, const char* name) {
+  using namespace datasketches;
+  using SK = kll_sketch<py_keyed_item, py_keyed_item_lt>;
+
+  // converts Python values to keyed items using the sketch's key function
+  auto make_items = [](const SK& sk, nb::handle values) {
+    const py_keyed_item_lt lt = sk.get_comparator();
+    std::vector<py_keyed_item> items;
+    for (nb::handle value: values) items.push_back(lt.make(nb::borrow(value)));
+    return items;
+  };
+
+  // converts Python values used directly as sort keys
+  auto make_key_points = [](nb::handle keys) {
+    std::vector<py_keyed_item> points;
+    for (nb::handle key: keys) points.push_back(make_key_point(key));
+    return points;
+  };
+
+  nb::class_<SK>(m, name,
+    "A KLL sketch of arbitrary Python objects that are ordered by a native sort key. "
+    "The key is computed once per item, so sorting and merging never call back into Python.")
+    .def(
+        "__init__",
+        [](SK* sk, uint16_t k, nb::object key) { new (sk) SK(k, py_keyed_item_lt(std::move(key))); },
+        nb::arg("k")=kll_constants::DEFAULT_K, nb::arg("key")=nb::none(),
+        "Creates a KLL sketch instance with the given value of k, ordering items by the given key function.\n\n"
+        ":param k: Controls the size/accuracy trade-off of the sketch. Default is 200.\n"
+        ":type k: int, optional\n"
+        ":param key: A function mapping each item to its sort key, which must be an int, float, str or bytes, "
+        "as with sorted(key=...). Ints and floats compare by value and sort before strings. "
+        "If None, each item is its own key.\n"
+        ":type key: callable, optional"
+    )
+    .def("__copy__", [](const SK& sk){ return SK(sk); })
+    .def("update", [](SK& sk, nb::object item) { sk.update(sk.get_comparator().make(std::move(item))); }, nb::arg("item"),
+        "Updates the sketch with the given item, computing its sort key")
+    .def("merge", [](SK& sk, const SK& other) { sk.merge(other); }, nb::arg("sketch"),
+        "Merges the provided sketch into this one. Both sketches are expected to use the same key function.")
+    .def("__str__", [](const SK& sk) { return sk.to_string(); },
+        "Produces a string summary of the sketch")
+    .def("to_string", &SK::to_string, nb::arg("print_levels")=false, nb::arg("print_items")=false,
+        "Produces a string summary of the sketch")
+    .def("is_empty", &SK::is_empty,
+        "Returns True if the sketch is empty, otherwise False")
+    .def_prop_ro("k", &SK::get_k,
+        "The configured parameter k")
+    .def_prop_ro("n", &SK::get_n,
+        "The length of the input stream")
+    .def_prop_ro("num_retained", &SK::get_num_retained,
+        "The number of retained items (samples) in the sketch")
+    .def_prop_ro("key", [](const SK& sk) { return sk.get_comparator().key_func; },
+        "The key function, or None if items are their own keys")
+    .def("is_estimation_mode", &SK::is_estimation_mode,
+        "Returns True if the sketch is in estimation mode, otherwise False")
+    .def("get_min_value", [](const SK& sk) { return sk.get_min_item().item; },
+        "Returns the item with the smallest key from the stream. If empty, throws a RuntimeError")
+    .def("get_max_value", [](const SK& sk) { return sk.get_max_item().item; },
+        "Returns the item with the largest key from the stream. If empty, throws a RuntimeError")
+    .def("get_quantile",
+        [](const SK& sk, double rank, bool inclusive) { return sk.get_quantile(rank, inclusive).item; },
+        nb::arg("rank"), nb::arg("inclusive")=false,
+        "Returns an approximation to the item associated with the given normalized rank "
+        "in a hypothetical sorted version of the input stream so far.\n"
+        "If the sketch is empty this throws a RuntimeError.")
+    .def(
+        "get_quantiles",
+        [](const SK& sk, const std::vector<double>& ranks, bool inclusive) {
+          nb::list quantiles;
+          if (!sk.is_empty()) {
+            for (double rank: ranks) quantiles.append(sk.get_quantile(rank, inclusive).item);
+          }
+          return quantiles;
+        },
+        nb::arg("ranks"), nb::arg("inclusive")=false,
+        "This returns a list that could have been generated by using get_quantile() for each "
+        "normalized rank separately.\n"
+        "If the sketch is empty this returns an empty list."
+    )
+    .def("get_rank",
+        [](const SK& sk, nb::object value, bool inclusive) {
+          return sk.get_rank(sk.get_comparator().make(std::move(value)), inclusive);
+        },
+        nb::arg("value"), nb::arg("inclusive")=false,
+        "Returns an approximation to the normalized rank of the given value from 0 to 1, inclusive, "
+        "comparing by the sort key the key function computes for the value. "
+        "Use get_rank_by_key() to query a sort key directly.\n"
+        "With the parameter inclusive=true the weight of the given value is included into the rank. "
+        "Otherwise the rank equals the sum of the weights of values less than the given value.")
+    .def("get_rank_by_key",
+        [](const SK& sk, nb::handle key, bool inclusive) {
+          return sk.get_rank(make_key_point(key), inclusive);
+        },
+        nb::arg("key"), nb::arg("inclusive")=false,
+        "Returns an approximation to the normalized rank of the given sort key from 0 to 1, inclusive. "
+        "The key is an int, float, str or bytes and is not passed through the key function.\n"
+        "With the parameter inclusive=true the weight of items with that key is included into the rank. "
+        "Otherwise the rank equals the sum of the weights of items with smaller keys.")
+    .def(
+        "get_pmf",
+        [make_items](const SK& sk, nb::handle split_points, bool inclusive) {
+          const auto points = make_items(sk, split_points);
+          return sk.get_PMF(points.data(), static_cast<uint32_t>(points.size()), inclusive);
+        },
+        nb::arg("split_points"), nb::arg("inclusive")=false,
+        "Returns an approximation to the Probability Mass Function (PMF) of the input stream "
+        "given a list of split points, which must be unique and monotonically increasing by their sort keys. "
+        "The split points are items, passed through the key function; use get_pmf_by_key() "
+        "to give sort keys directly.\n"
+        "If the sketch is empty this returns an empty vector."
+    )
+    .def(
+        "get_pmf_by_key",
+        [make_key_points](const SK& sk, nb::handle split_keys, bool inclusive) {
+          const auto points = make_key_points(split_keys);
+          return sk.get_PMF(points.data(), static_cast<uint32_t>(points.size()), inclusive);
+        },
+        nb::arg("split_keys"), nb::arg("inclusive")=false,
+        "Returns an approximation to the Probability Mass Function (PMF) of the input stream "
+        "given a list of sort keys as split points, which must be unique and monotonically increasing. "
+        "The keys are ints, floats, str or bytes and are not passed through the key function.\n"
+        "If the sketch is empty this returns an empty vector."
+    )
+    .def(
+        "get_cdf",
+        [make_items](const SK& sk, nb::handle split_points, bool inclusive) {
+          const auto points = make_items(sk, split_points);
+          return sk.get_CDF(points.data(), static_cast<uint32_t>(points.size()), inclusive);
+        },
+        nb::arg("split_points"), nb::arg("inclusive")=false,
+        "Returns an approximation to the Cumulative Distribution Function (CDF) of the input stream "
+        "given a list of split points, which must be unique and monotonically increasing by their sort keys. "
+        "The split points are items, passed through the key function; use get_cdf_by_key() "
+        "to give sort keys directly.\n"
+        "If the sketch is empty this returns an empty vector."
+    )
+    .def(
+        "get_cdf_by_key",
+        [make_key_points](const SK& sk, nb::handle split_keys, bool inclusive) {
+          const auto points = make_key_points(split_keys);
+          return sk.get_CDF(points.data(), static_cast<uint32_t>(points.size()), inclusive);
+        },
+        nb::arg("split_keys"), nb::arg("inclusive")=false,
+        "Returns an approximation to the Cumulative Distribution Function (CDF) of the input stream "
+        "given a list of sort keys as split points, which must be unique and monotonically increasing. "
+        "The keys are ints, floats, str or bytes and are not passed through the key function.\n"
+        "If the sketch is empty this returns an empty vector."
+    )
+    .def(
+        "normalized_rank_error",
+        static_cast<double (SK::*)(bool) const>(&SK::get_normalized_rank_error),
+         nb::arg("as_pmf"),
+         "Gets the normalized rank error for this sketch.\n"
+         "If pmf is True, returns the 'double-sided' normalized rank error for the get_PMF() function.\n"
+         "Otherwise, it is the 'single-sided' normalized rank error for all the other queries."
+    )
+    .def_static(
+        "get_normalized_rank_error",
+        [](uint16_t k, bool pmf) { return SK::get_normalized_rank_error(k, pmf); },
+         nb::arg("k"), nb::arg("as_pmf"),
+         "Gets the normalized rank error given parameters k and the pmf flag.\n"
+         "If pmf is True, returns the 'double-sided' normalized rank error for the get_PMF() function.\n"
+         "Otherwise, it is the 'single-sided' normalized rank error for all the other queries."
+    )
+    .def("__iter__",
+        [](const SK& sk) {
+          nb::list items;
+          for (const auto& entry: sk) items.append(nb::make_tuple(entry.first.item, entry.second));
+          return nb::iter(items);
+        }
+    )
+    .def(
+        "get_serialized_size_bytes",
+        [](const SK& sk, py_object_serde& serde) {
+          const py_keyed_item_lt lt = sk.get_comparator();
+          return sk.get_serialized_size_bytes(py_keyed_item_serde{serde, lt});
+        },
+        nb::arg("serde"),
+        "Returns the size of the serialized sketch, in bytes"
+    )
+    .def(
+        "serialize",
+        [](const SK& sk, py_object_serde& serde) {
+          const py_keyed_item_lt lt = sk.get_comparator();
+          const py_keyed_item_serde keyed_serde{serde, lt};
+          return serialize_to_bytes(sk.get_serialized_size_bytes(keyed_serde),
+            [&sk, &keyed_serde](std::ostream& os) { sk.serialize(os, keyed_serde); });
+        },
+        nb::arg("serde"),
+        "Serializes the sketch into a bytes object using the provided serde. Only the items are written, "
+        "so the result is the same as for a kll_items_sketch holding them."
+    )
+    .def(
+        "serialize_into",
+        [](const SK& sk, nb::handle buffer, py_object_serde& serde, size_t offset) {
+          const py_keyed_item_lt lt = sk.get_comparator();
+          const py_keyed_item_serde keyed_serde{serde, lt};
+          return serialize_into(buffer, offset, sk.get_serialized_size_bytes(keyed_serde), [&sk, &keyed_serde](std::ostream& os) { sk.serialize(os, keyed_serde); });
+        },
+        nb::arg("buffer"), nb::arg("serde"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset "
+        "and using the provided serde. Returns the number of bytes written."
+    )
+    .def_static(
+        "deserialize",
+        [](nb::handle bytes, py_object_serde& serde, nb::object key, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
+          const py_keyed_item_lt lt(std::move(key));
+          return SK::deserialize(buffer.data(), buffer.size(), py_keyed_item_serde{serde, lt}, lt);
+        },
+        nb::arg("bytes"), nb::arg("serde"), nb::arg("key")=nb::none(),
+        nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, and returns the "
+        "corresponding sketch, recomputing the sort key of each item with the given key function"
+    );
 }
 
 void init_kll(nb::module_ &m) {
   bind_kll_sketch<int, std::less<int>>(m, "kll_ints_sketch");
   bind_kll_sketch<float, std::less<float>>(m, "kll_floats_sketch");
   bind_kll_sketch<double, std::less<double>>(m, "kll_doubles_sketch");
+  bind_kll_sketch<int64_t, std::less<int64_t>>(m, "kll_longs_sketch");
+  bind_kll_sketch<uint64_t, std::less<uint64_t>>(m, "kll_ulongs_sketch");
+  bind_kll_sketch<std::string, std::less<std::string>>(m, "kll_strings_sketch");
   bind_kll_sketch<nb::object, py_object_lt>(m, "kll_items_sketch");
+  bind_kll_keyed_items_sketch(m, "kll_keyed_items_sketch");
 }
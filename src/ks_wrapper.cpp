@@ -17,15 +17,77 @@
  * under the License.
  */
 
+#include <deque>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
 #include "kolmogorov_smirnov.hpp"
 #include "kll_sketch.hpp"
 #include "quantiles_sketch.hpp"
+#include "gil_release.hpp"
+#include "ks_batch.hpp"
+#include "py_ndarray.hpp"
 #include "py_object_lt.hpp"
 
 #include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
 
 namespace nb = nanobind;
 
+// Copies the sketches of a list with the GIL held, each distinct object once, so that
+// the tests can run without it. The objects are kept alive in refs until the tests are
+// done, since their addresses tell repeated objects apart.
+template<typename T, typename SK>
+std::vector<const SK*> copy_sketch_list(const nb::sequence& sketches, const char* name, std::vector<nb::object>& refs,
+                                        std::unordered_map<PyObject*, const SK*>& copied, std::deque<SK>& copies) {
+  std::vector<const SK*> pointers;
+  size_t i = 0;
+  for (nb::handle item: sketches) {
+    if (!nb::isinstance<SK>(item)) {
+      const std::string type_name = nb::type_name(item.type()).c_str();
+      const std::string expected = nb::type_name(nb::type<SK>()).c_str();
+      throw nb::type_error(("ks_test_many requires all sketches to be of the same type: " + std::string(name)
+        + "[" + std::to_string(i) + "] is a " + type_name + " but " + expected + " was expected").c_str());
+    }
+    refs.push_back(nb::borrow(item));
+    auto inserted = copied.emplace(item.ptr(), nullptr);
+    if (inserted.second) {
+      const SK& sk = nb::cast<const SK&>(item);
+      prepare_sorted_view<T>(sk);
+      copies.push_back(sk);
+      inserted.first->second = &copies.back();
+    }
+    pointers.push_back(inserted.first->second);
+    ++i;
+  }
+  return pointers;
+}
+
+// Tests lists of sketches of type SK, or returns nothing if the first sketch is of another type
+template<typename T, typename SK>
+std::optional<nb::tuple> ks_test_sketch_lists(const nb::sequence& sketches_1, const nb::sequence& sketches_2,
+                                              double p, unsigned num_threads) {
+  using namespace datasketches;
+
+  if (!nb::isinstance<SK>(sketches_1[0])) return std::nullopt;
+  std::vector<nb::object> refs;
+  std::unordered_map<PyObject*, const SK*> copied;
+  std::deque<SK> copies;
+  const auto pointers_1 = copy_sketch_list<T>(sketches_1, "sketches_1", refs, copied, copies);
+  const auto pointers_2 = copy_sketch_list<T>(sketches_2, "sketches_2", refs, copied, copies);
+
+  auto rejected = make_numpy_array<bool>(pointers_1.size());
+  auto statistics = make_numpy_array<double>(pointers_1.size());
+  {
+    nb::gil_scoped_release release;
+    ks_test_pairs(pointers_1, pointers_2, p, num_threads, rejected.data(), statistics.data());
+  }
+  return nb::make_tuple(rejected, statistics);
+}
+
 void init_kolmogorov_smirnov(nb::module_ &m) {
   using namespace datasketches;
 
@@ -78,4 +140,36 @@ void init_kolmogorov_smirnov(nb::module_ &m) {
     "this will return false.\n"
     "Returns True if we can reject the null hypothesis (that the sketches reflect the same underlying "
     "distribution) using the provided p-value, otherwise False.");
+
+  m.def("ks_test_many",
+      [](const nb::sequence& sketches_1, const nb::sequence& sketches_2, double p, unsigned num_threads) {
+        if (nb::len(sketches_1) != nb::len(sketches_2)) {
+          throw std::invalid_argument("Must have the same number of sketches on both sides: "
+            + std::to_string(nb::len(sketches_1)) + " and " + std::to_string(nb::len(sketches_2)));
+        }
+        if (nb::len(sketches_1) == 0) {
+          return nb::make_tuple(make_numpy_array<bool>(0), make_numpy_array<double>(0));
+        }
+        std::optional<nb::tuple> result;
+        if (!result) result = ks_test_sketch_lists<int, kll_sketch<int>>(sketches_1, sketches_2, p, num_threads);
+        if (!result) result = ks_test_sketch_lists<float, kll_sketch<float>>(sketches_1, sketches_2, p, num_threads);
+        if (!result) result = ks_test_sketch_lists<double, kll_sketch<double>>(sketches_1, sketches_2, p, num_threads);
+        if (!result) result = ks_test_sketch_lists<int64_t, kll_sketch<int64_t>>(sketches_1, sketches_2, p, num_threads);
+        if (!result) result = ks_test_sketch_lists<int, quantiles_sketch<int>>(sketches_1, sketches_2, p, num_threads);
+        if (!result) result = ks_test_sketch_lists<float, quantiles_sketch<float>>(sketches_1, sketches_2, p, num_threads);
+        if (!result) result = ks_test_sketch_lists<double, quantiles_sketch<double>>(sketches_1, sketches_2, p, num_threads);
+        if (!result) {
+          throw nb::type_error("ks_test_many supports lists of kll_ints_sketch, kll_floats_sketch, kll_doubles_sketch, "
+            "kll_longs_sketch, quantiles_ints_sketch, quantiles_floats_sketch or quantiles_doubles_sketch");
+        }
+        return *result;
+      },
+      nb::arg("sketches_1"), nb::arg("sketches_2"), nb::arg("p"), nb::arg("num_threads")=1,
+    "Performs the Kolmogorov-Smirnov Test between each pair of sketches at the same position in two lists "
+    "of matched-type KLL or classic quantiles sketches, such as many features against a baseline.\n"
+    "Returns a tuple of two arrays: whether the null hypothesis (that both sketches reflect the same underlying "
+    "distribution) can be rejected using the provided p-value, and the test statistic of each pair. "
+    "Pairs with an empty sketch are not rejected. "
+    "Each distinct sketch is copied and its sorted view built once, and with `num_threads` > 1 the pairs are "
+    "tested in parallel; 0 uses one thread per core.");
 }
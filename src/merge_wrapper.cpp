@@ -0,0 +1,212 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common_defs.hpp"
+#include "count_min.hpp"
+#include "cpc_sketch.hpp"
+#include "cpc_union.hpp"
+#include "hll.hpp"
+#include "kll_sketch.hpp"
+#include "quantiles_sketch.hpp"
+#include "req_sketch.hpp"
+#include "tdigest.hpp"
+#include "theta_sketch.hpp"
+#include "theta_union.hpp"
+
+#include "parallel_reduce.hpp"
+
+#include <nanobind/nanobind.h>
+#include <nanobind/stl/optional.h>
+
+namespace nb = nanobind;
+
+namespace datasketches {
+
+// Copies the C++ sketch behind each object with the GIL held, so that the
+// merge can run without it while other threads keep using the inputs.
+template<typename SK, typename F>
+auto copy_sketches(const std::vector<nb::object>& items, F copy) {
+  std::vector<decltype(copy(std::declval<const SK&>()))> sketches;
+  sketches.reserve(items.size());
+  for (const nb::object& item: items) {
+    if (!nb::isinstance<SK>(item)) {
+      throw nb::type_error("parallel_merge requires all sketches to be of the same type");
+    }
+    sketches.push_back(copy(nb::cast<const SK&>(item)));
+  }
+  return sketches;
+}
+
+template<typename SK>
+std::vector<SK> copy_sketches(const std::vector<nb::object>& items) {
+  return copy_sketches<SK>(items, [](const SK& sk) { return SK(sk); });
+}
+
+// sketches with a merge method, starting from the copy of the first input
+template<typename SK>
+nb::object merge_sketches(const std::vector<nb::object>& items, unsigned num_threads) {
+  auto sketches = copy_sketches<SK>(items);
+  std::optional<SK> result;
+  {
+    nb::gil_scoped_release release;
+    auto merged = tree_reduce<SK>(sketches.size(), num_threads,
+      [&sketches](std::optional<SK>& acc, size_t i) {
+        if (acc) acc->merge(std::move(sketches[i]));
+        else acc.emplace(std::move(sketches[i]));
+      },
+      [](SK& acc, SK&& other) { acc.merge(std::move(other)); }
+    );
+    result.emplace(std::move(*merged));
+  }
+  return nb::cast(std::move(*result));
+}
+
+static nb::object merge_hll(const std::vector<nb::object>& items, unsigned num_threads,
+                            const std::optional<uint8_t>& lg_k) {
+  auto sketches = copy_sketches<hll_sketch>(items);
+  uint8_t lg_max_k = 0;
+  if (lg_k) lg_max_k = *lg_k;
+  else for (const hll_sketch& sk: sketches) lg_max_k = std::max(lg_max_k, sk.get_lg_config_k());
+  const target_hll_type tgt_type = sketches[0].get_target_type();
+  std::optional<hll_sketch> result;
+  {
+    nb::gil_scoped_release release;
+    auto u = tree_reduce<hll_union>(sketches.size(), num_threads,
+      [&sketches, lg_max_k](std::optional<hll_union>& acc, size_t i) {
+        if (!acc) acc.emplace(lg_max_k);
+        acc->update(std::move(sketches[i]));
+      },
+      [](hll_union& acc, hll_union&& other) { acc.update(other.get_result(HLL_8)); }
+    );
+    result.emplace(u->get_result(tgt_type));
+  }
+  return nb::cast(std::move(*result));
+}
+
+static nb::object merge_cpc(const std::vector<nb::object>& items, unsigned num_threads,
+                            const std::optional<uint8_t>& lg_k, uint64_t seed) {
+  auto sketches = copy_sketches<cpc_sketch>(items);
+  uint8_t union_lg_k = 0;
+  if (lg_k) union_lg_k = *lg_k;
+  else for (const cpc_sketch& sk: sketches) union_lg_k = std::max(union_lg_k, sk.get_lg_k());
+  std::optional<cpc_sketch> result;
+  {
+    nb::gil_scoped_release release;
+    auto u = tree_reduce<cpc_union>(sketches.size(), num_threads,
+      [&sketches, union_lg_k, seed](std::optional<cpc_union>& acc, size_t i) {
+        if (!acc) acc.emplace(union_lg_k, seed);
+        acc->update(std::move(sketches[i]));
+      },
+      [](cpc_union& acc, cpc_union&& other) { acc.update(other.get_result()); }
+    );
+    result.emplace(u->get_result());
+  }
+  return nb::cast(std::move(*result));
+}
+
+// accepts both update and compact sketches, returning an ordered compact sketch
+static nb::object merge_theta(const std::vector<nb::object>& items, unsigned num_threads,
+                              const std::optional<uint8_t>& lg_k, uint64_t seed) {
+  uint8_t union_lg_k = lg_k ? *lg_k : 0;
+  // update sketches are copied in compact form, and only these record their nominal size
+  auto sketches = copy_sketches<theta_sketch>(items, [&lg_k, &union_lg_k](const theta_sketch& sk) {
+    auto update_sk = dynamic_cast<const update_theta_sketch*>(&sk);
+    if (!lg_k && update_sk != nullptr) union_lg_k = std::max(union_lg_k, update_sk->get_lg_k());
+    return compact_theta_sketch(sk, false);
+  });
+  if (union_lg_k == 0) union_lg_k = theta_constants::DEFAULT_LG_K;
+  std::optional<compact_theta_sketch> result;
+  {
+    nb::gil_scoped_release release;
+    auto u = tree_reduce<theta_union>(sketches.size(), num_threads,
+      [&sketches, union_lg_k, seed](std::optional<theta_union>& acc, size_t i) {
+        if (!acc) acc.emplace(theta_union::builder().set_lg_k(union_lg_k).set_seed(seed).build());
+        acc->update(std::move(sketches[i]));
+      },
+      [](theta_union& acc, theta_union&& other) { acc.update(other.get_result()); }
+    );
+    result.emplace(u->get_result());
+  }
+  return nb::cast(std::move(*result));
+}
+
+static nb::object parallel_merge(nb::handle sketches, unsigned num_threads,
+                                 const std::optional<uint8_t>& lg_k, uint64_t seed) {
+  std::vector<nb::object> items;
+  for (nb::handle item: sketches) items.push_back(nb::borrow(item));
+  if (items.empty()) throw std::invalid_argument("parallel_merge requires at least one sketch");
+  const nb::handle first = items[0];
+
+  if (nb::isinstance<kll_sketch<int>>(first)) return merge_sketches<kll_sketch<int>>(items, num_threads);
+  if (nb::isinstance<kll_sketch<float>>(first)) return merge_sketches<kll_sketch<float>>(items, num_threads);
+  if (nb::isinstance<kll_sketch<double>>(first)) return merge_sketches<kll_sketch<double>>(items, num_threads);
+  if (nb::isinstance<kll_sketch<int64_t>>(first)) return merge_sketches<kll_sketch<int64_t>>(items, num_threads);
+  if (nb::isinstance<kll_sketch<uint64_t>>(first)) return merge_sketches<kll_sketch<uint64_t>>(items, num_threads);
+  if (nb::isinstance<kll_sketch<std::string>>(first)) return merge_sketches<kll_sketch<std::string>>(items, num_threads);
+  if (nb::isinstance<quantiles_sketch<int>>(first)) return merge_sketches<quantiles_sketch<int>>(items, num_threads);
+  if (nb::isinstance<quantiles_sketch<float>>(first)) return merge_sketches<quantiles_sketch<float>>(items, num_threads);
+  if (nb::isinstance<quantiles_sketch<double>>(first)) return merge_sketches<quantiles_sketch<double>>(items, num_threads);
+  if (nb::isinstance<quantiles_sketch<int64_t>>(first)) return merge_sketches<quantiles_sketch<int64_t>>(items, num_threads);
+  if (nb::isinstance<quantiles_sketch<uint64_t>>(first)) return merge_sketches<quantiles_sketch<uint64_t>>(items, num_threads);
+  if (nb::isinstance<quantiles_sketch<std::string>>(first)) return merge_sketches<quantiles_sketch<std::string>>(items, num_threads);
+  if (nb::isinstance<req_sketch<int>>(first)) return merge_sketches<req_sketch<int>>(items, num_threads);
+  if (nb::isinstance<req_sketch<float>>(first)) return merge_sketches<req_sketch<float>>(items, num_threads);
+  if (nb::isinstance<req_sketch<double>>(first)) return merge_sketches<req_sketch<double>>(items, num_threads);
+  if (nb::isinstance<req_sketch<int64_t>>(first)) return merge_sketches<req_sketch<int64_t>>(items, num_threads);
+  if (nb::isinstance<req_sketch<uint64_t>>(first)) return merge_sketches<req_sketch<uint64_t>>(items, num_threads);
+  if (nb::isinstance<req_sketch<std::string>>(first)) return merge_sketches<req_sketch<std::string>>(items, num_threads);
+  if (nb::isinstance<tdigest<float>>(first)) return merge_sketches<tdigest<float>>(items, num_threads);
+  if (nb::isinstance<tdigest<double>>(first)) return merge_sketches<tdigest<double>>(items, num_threads);
+  if (nb::isinstance<count_min_sketch<double>>(first)) return merge_sketches<count_min_sketch<double>>(items, num_threads);
+  if (nb::isinstance<hll_sketch>(first)) return merge_hll(items, num_threads, lg_k);
+  if (nb::isinstance<cpc_sketch>(first)) return merge_cpc(items, num_threads, lg_k, seed);
+  if (nb::isinstance<theta_sketch>(first)) return merge_theta(items, num_threads, lg_k, seed);
+
+  throw nb::type_error("parallel_merge does not support sketches of this type");
+}
+
+}
+
+void init_parallel_merge(nb::module_ &m) {
+  using namespace datasketches;
+
+  m.def("parallel_merge", &parallel_merge,
+    nb::arg("sketches"), nb::arg("num_threads")=0, nb::arg("lg_k")=nb::none(), nb::arg("seed")=DEFAULT_SEED,
+    "Merges a list of sketches of the same type into a single new sketch using several threads. "
+    "The inputs are handed out to the threads as each becomes free, and the partial results are "
+    "then combined pairwise in a tree reduction, without holding the GIL. The inputs are copied first and are not modified.\n"
+    "Supports the KLL, quantiles and REQ sketches of numeric and string types, t-digest, count-min, HLL, CPC and theta sketches. "
+    "HLL, CPC and theta sketches are combined with a union, the result being a sketch of the same "
+    "target HLL type as the first input, a CPC sketch or an ordered compact theta sketch, respectively.\n\n"
+    ":param sketches: the sketches to merge, all of the same type\n:type sketches: list\n"
+    ":param num_threads: the number of threads to use. Default 0, one thread per core\n:type num_threads: int, optional\n"
+    ":param lg_k: for HLL, CPC and theta sketches, the log2 of the size of the union. "
+    "By default the largest among the inputs, or the default theta lg_k if only compact theta sketches are given\n"
+    ":type lg_k: int, optional\n"
+    ":param seed: for CPC and theta sketches, the seed used to hash the inputs. Default DEFAULT_SEED\n:type seed: int, optional\n"
+    ":return: the merged sketch"
+  );
+}
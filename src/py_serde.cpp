@@ -18,6 +18,9 @@
  */
 
 #include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
 #include "memory_operations.hpp"
 
 #include "py_serde.hpp"
@@ -50,6 +53,30 @@ void init_serde(nb::module_& m) {
         ":rtype: tuple(object, int)"
         )
     ;
+
+  nb::class_<py_strings_serde, py_object_serde, PyNativeSerDe<py_strings_serde>>(m, "PyStringsSerDe",
+    "Implements a string-encoding scheme where a string is written as `<num_bytes> <string_contents>`, "
+    "with the contents encoded as UTF-8 and no null termination. "
+    "This format allows pre-allocating each string, at the cost of additional storage, and is the format "
+    "used for strings by the C++ and Java libraries. Using this format, the serialized string consumes "
+    "``4 + len(item.encode())`` bytes. Implemented natively, without calls into Python for each item.")
+    .def(nb::init<>());
+  nb::class_<py_numeric_serde<int32_t>, py_object_serde, PyNativeSerDe<py_numeric_serde<int32_t>>>(m, "PyIntsSerDe",
+    "Implements an integer encoding scheme where each integer is written as a 32-bit (4 byte) little-endian value. "
+    "Implemented natively, without calls into Python for each item.")
+    .def(nb::init<>());
+  nb::class_<py_numeric_serde<int64_t>, py_object_serde, PyNativeSerDe<py_numeric_serde<int64_t>>>(m, "PyLongsSerDe",
+    "Implements an integer encoding scheme where each integer is written as a 64-bit (8 byte) little-endian value. "
+    "Implemented natively, without calls into Python for each item.")
+    .def(nb::init<>());
+  nb::class_<py_numeric_serde<float>, py_object_serde, PyNativeSerDe<py_numeric_serde<float>>>(m, "PyFloatsSerDe",
+    "Implements a floating point encoding scheme where each value is written as a 32-bit little-endian floating point value. "
+    "Implemented natively, without calls into Python for each item.")
+    .def(nb::init<>());
+  nb::class_<py_numeric_serde<double>, py_object_serde, PyNativeSerDe<py_numeric_serde<double>>>(m, "PyDoublesSerDe",
+    "Implements a floating point encoding scheme where each value is written as a 64-bit little-endian floating point value. "
+    "Implemented natively, without calls into Python for each item.")
+    .def(nb::init<>());
 }    
 
 namespace datasketches {
@@ -71,6 +98,14 @@ namespace datasketches {
     return bytes_written;
   }
 
+  void py_object_serde::serialize(std::ostream& os, const nb::object* items, unsigned num) const {
+    nb::gil_scoped_acquire acquire;
+    for (unsigned i = 0; i < num; ++i) {
+      nb::bytes bytes = to_bytes(items[i]);
+      os.write(bytes.c_str(), bytes.size());
+    }
+  }
+
   size_t py_object_serde::deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const {
     size_t bytes_read = 0;
     unsigned i = 0;
@@ -120,5 +155,158 @@ namespace datasketches {
     return bytes_read;
   }
 
+  nb::bytes PyObjectSerDe::to_bytes_many(nb::handle method, const nb::object* items, unsigned num) const {
+    nb::list list;
+    for (unsigned i = 0; i < num; ++i) list.append(items[i]);
+    nb::object bytes = method(list);
+    if (!nb::isinstance<nb::bytes>(bytes)) throw nb::type_error("to_bytes_many must return a bytes object");
+    return nb::borrow<nb::bytes>(bytes);
+  }
+
+  size_t PyObjectSerDe::serialize(void* ptr, size_t capacity, const nb::object* items, unsigned num) const {
+    nb::gil_scoped_acquire acquire;
+    nb::handle self = nb_trampoline.base();
+    if (!nb::hasattr(self, "to_bytes_many")) return py_object_serde::serialize(ptr, capacity, items, num);
+    nb::bytes bytes = to_bytes_many(self.attr("to_bytes_many"), items, num);
+    check_memory_size(bytes.size(), capacity);
+    memcpy(ptr, bytes.c_str(), bytes.size());
+    return bytes.size();
+  }
+
+  void PyObjectSerDe::serialize(std::ostream& os, const nb::object* items, unsigned num) const {
+    nb::gil_scoped_acquire acquire;
+    nb::handle self = nb_trampoline.base();
+    if (!nb::hasattr(self, "to_bytes_many")) return py_object_serde::serialize(os, items, num);
+    nb::bytes bytes = to_bytes_many(self.attr("to_bytes_many"), items, num);
+    os.write(bytes.c_str(), bytes.size());
+  }
+
+  size_t PyObjectSerDe::deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const {
+    nb::gil_scoped_acquire acquire;
+    nb::handle self = nb_trampoline.base();
+    if (!nb::hasattr(self, "from_bytes_many")) return py_object_serde::deserialize(ptr, capacity, items, num);
+
+    // a read-only view of the sketch's memory rather than a copy; it is released
+    // afterwards so that any reference kept by the serde cannot outlive the data.
+    // Serdes must not keep the view: releasing it fails with BufferError while it
+    // is still exported, and that error is discarded rather than reported.
+    nb::object view = nb::steal(PyMemoryView_FromMemory(
+      const_cast<char*>(static_cast<const char*>(ptr)), static_cast<Py_ssize_t>(capacity), PyBUF_READ));
+    if (!view.is_valid()) throw nb::python_error();
+    auto release_view = [&view]() {
+      PyObject* released = PyObject_CallMethod(view.ptr(), "release", nullptr);
+      if (released == nullptr) PyErr_Clear();
+      Py_XDECREF(released);
+    };
+    nb::object result;
+    try {
+      result = self.attr("from_bytes_many")(view, 0, num);
+    } catch (...) {
+      release_view();
+      throw;
+    }
+    release_view();
+
+    nb::tuple values_and_len = nb::cast<nb::tuple>(result);
+    if (values_and_len.size() != 2) throw nb::value_error("from_bytes_many must return a tuple of a list and a length");
+    nb::list values = nb::cast<nb::list>(values_and_len[0]);
+    const size_t bytes_read = nb::cast<size_t>(values_and_len[1]);
+    if (values.size() != num) {
+      throw std::invalid_argument("from_bytes_many returned " + std::to_string(values.size())
+        + " items, expected " + std::to_string(num));
+    }
+    check_memory_size(bytes_read, capacity);
+
+    unsigned i = 0;
+    for (nb::handle value: values) new (&items[i++]) nb::object(nb::borrow(value));
+    return bytes_read;
+  }
+
+  // returns the UTF-8 encoding cached within the str object, which requires the GIL
+  static std::string_view utf8_view(const nb::object& item) {
+    Py_ssize_t size = 0;
+    const char* data = PyUnicode_AsUTF8AndSize(item.ptr(), &size);
+    if (data == nullptr) throw nb::python_error();
+    return std::string_view(data, static_cast<size_t>(size));
+  }
+
+  int64_t py_strings_serde::get_size(const nb::object& item) const {
+    return sizeof(uint32_t) + utf8_view(item).size();
+  }
+
+  nb::bytes py_strings_serde::to_bytes(const nb::object& item) const {
+    const std::string_view str = utf8_view(item);
+    const uint32_t length = static_cast<uint32_t>(str.size());
+    std::string bytes(sizeof(length) + str.size(), '\0');
+    serde_bytes::store_le(&bytes[0], length);
+    memcpy(&bytes[sizeof(length)], str.data(), str.size());
+    return nb::bytes(bytes.data(), bytes.size());
+  }
+
+  nb::tuple py_strings_serde::from_bytes(nb::bytes& bytes, size_t offset) const {
+    check_memory_size(offset + sizeof(uint32_t), bytes.size());
+    const uint32_t length = serde_bytes::load_le<uint32_t>(bytes.c_str() + offset);
+    check_memory_size(offset + sizeof(length) + length, bytes.size());
+    nb::str str(bytes.c_str() + offset + sizeof(length), length);
+    return nb::make_tuple(str, sizeof(length) + length);
+  }
+
+  size_t py_strings_serde::size_of_item(const nb::object& item) const {
+    nb::gil_scoped_acquire acquire;
+    return get_size(item);
+  }
+
+  size_t py_strings_serde::serialize(void* ptr, size_t capacity, const nb::object* items, unsigned num) const {
+    size_t bytes_written = 0;
+    char* out = static_cast<char*>(ptr);
+    nb::gil_scoped_acquire acquire;
+    for (unsigned i = 0; i < num; ++i) {
+      const std::string_view str = utf8_view(items[i]);
+      const uint32_t length = static_cast<uint32_t>(str.size());
+      check_memory_size(bytes_written + sizeof(length) + str.size(), capacity);
+      serde_bytes::store_le(out + bytes_written, length);
+      memcpy(out + bytes_written + sizeof(length), str.data(), str.size());
+      bytes_written += sizeof(length) + str.size();
+    }
+    return bytes_written;
+  }
+
+  void py_strings_serde::serialize(std::ostream& os, const nb::object* items, unsigned num) const {
+    nb::gil_scoped_acquire acquire;
+    for (unsigned i = 0; i < num; ++i) {
+      const std::string_view str = utf8_view(items[i]);
+      char length[sizeof(uint32_t)];
+      serde_bytes::store_le(length, static_cast<uint32_t>(str.size()));
+      os.write(length, sizeof(length));
+      os.write(str.data(), str.size());
+    }
+  }
+
+  size_t py_strings_serde::deserialize(const void* ptr, size_t capacity, nb::object* items, unsigned num) const {
+    size_t bytes_read = 0;
+    unsigned i = 0;
+    const char* in = static_cast<const char*>(ptr);
+    nb::gil_scoped_acquire acquire;
+    try {
+      for (; i < num; ++i) {
+        check_memory_size(bytes_read + sizeof(uint32_t), capacity);
+        const uint32_t length = serde_bytes::load_le<uint32_t>(in + bytes_read);
+        bytes_read += sizeof(uint32_t);
+        check_memory_size(bytes_read + length, capacity);
+        PyObject* str = PyUnicode_DecodeUTF8(in + bytes_read, length, nullptr);
+        if (str == nullptr) throw nb::python_error();
+        new (&items[i]) nb::object(nb::steal(str));
+        bytes_read += length;
+      }
+    } catch (...) {
+      // clean up what we've allocated
+      for (unsigned j = 0; j < i; ++j) {
+        items[j].dec_ref();
+      }
+      throw;
+    }
+    return bytes_read;
+  }
+
 
 } // namespace datasketches
\ No newline at end of file
@@ -27,6 +27,7 @@
 
 #include "py_object_lt.hpp"
 #include "py_object_ostream.hpp"
+#include "gil_release.hpp"
 #include "quantile_conditional.hpp"
 #include "quantiles_sketch.hpp"
 
@@ -37,7 +38,11 @@ template<typename T, typename C>
 void bind_quantiles_sketch(nb::module_ &m, const char* name) {
   using namespace datasketches;
 
-  auto quantiles_class = nb::class_<quantiles_sketch<T, C>>(m, name)
+  auto quantiles_class = nb::class_<quantiles_sketch<T, C>>(m, name);
+  // numpy overloads come first, as the list versions would also accept arrays
+  add_vector_queries<T>(quantiles_class);
+
+  quantiles_class
     .def(nb::init<uint16_t>(), nb::arg("k")=quantiles_constants::DEFAULT_K,
          "Creates a classic quantiles sketch instance with the given value of k.\n\n"
          ":param k: Controls the size/accuracy trade-off of the sketch. Default is 128.\n"
@@ -70,7 +75,12 @@ void bind_quantiles_sketch(nb::module_ &m, const char* name) {
          "Returns the minimum value from the stream. If empty, quantiles_floats_sketch returns nan; quantiles_ints_sketch throws a RuntimeError")
     .def("get_max_value", &quantiles_sketch<T, C>::get_max_item,
          "Returns the maximum value from the stream. If empty, quantiles_floats_sketch returns nan; quantiles_ints_sketch throws a RuntimeError")
-    .def("get_quantile", &quantiles_sketch<T, C>::get_quantile, nb::arg("rank"), nb::arg("inclusive")=false,
+    .def("get_quantile",
+        [](const quantiles_sketch<T, C>& sk, double rank, bool inclusive) {
+          prepare_sorted_view<T>(sk);
+          return sk.get_quantile(rank, inclusive);
+        },
+        nb::arg("rank"), nb::arg("inclusive")=false,
          "Returns an approximation to the data value "
          "associated with the given rank in a hypothetical sorted "
          "version of the input stream so far.\n"
@@ -79,6 +89,7 @@ void bind_quantiles_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_quantiles",
         [](const quantiles_sketch<T, C>& sk, const std::vector<double>& ranks, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           std::vector<T> quantiles;
           if (!sk.is_empty()) {
             quantiles.reserve(ranks.size());
@@ -91,7 +102,12 @@ void bind_quantiles_sketch(nb::module_ &m, const char* name) {
         "normalized rank separately.\n"
         "If the sketch is empty this returns an empty vector."
     )
-    .def("get_rank", &quantiles_sketch<T, C>::get_rank, nb::arg("value"), nb::arg("inclusive")=false,
+    .def("get_rank",
+        [](const quantiles_sketch<T, C>& sk, const T& value, bool inclusive) {
+          prepare_sorted_view<T>(sk);
+          return sk.get_rank(value, inclusive);
+        },
+        nb::arg("value"), nb::arg("inclusive")=false,
          "Returns an approximation to the normalized rank of the given value from 0 to 1, inclusive.\n"
          "The resulting approximation has a probabilistic guarantee that can be obtained from the "
          "get_normalized_rank_error(False) function.\n"
@@ -101,6 +117,7 @@ void bind_quantiles_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_pmf",
         [](const quantiles_sketch<T, C>& sk, const std::vector<T>& split_points, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           return sk.get_PMF(split_points.data(), split_points.size(), inclusive);
         },
         nb::arg("split_points"), nb::arg("inclusive")=false,
@@ -119,6 +136,7 @@ void bind_quantiles_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_cdf",
         [](const quantiles_sketch<T, C>& sk, const std::vector<T>& split_points, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           return sk.get_CDF(split_points.data(), split_points.size(), inclusive);
         },
         nb::arg("split_points"), nb::arg("inclusive")=false,
@@ -163,12 +181,18 @@ void bind_quantiles_sketch(nb::module_ &m, const char* name) {
      ;
 
     add_serialization<T>(quantiles_class);
-    add_vector_update<T>(quantiles_class);
+    add_vector_update<T>(quantiles_class, [](const quantiles_sketch<T, C>& sk) {
+      return quantiles_sketch<T, C>(sk.get_k(), sk.get_comparator());
+    });
+    add_sorted_view<T>(quantiles_class);
 }
 
 void init_quantiles(nb::module_ &m) {
   bind_quantiles_sketch<int, std::less<int>>(m, "quantiles_ints_sketch");
   bind_quantiles_sketch<float, std::less<float>>(m, "quantiles_floats_sketch");
   bind_quantiles_sketch<double, std::less<double>>(m, "quantiles_doubles_sketch");
+  bind_quantiles_sketch<int64_t, std::less<int64_t>>(m, "quantiles_longs_sketch");
+  bind_quantiles_sketch<uint64_t, std::less<uint64_t>>(m, "quantiles_ulongs_sketch");
+  bind_quantiles_sketch<std::string, std::less<std::string>>(m, "quantiles_strings_sketch");
   bind_quantiles_sketch<nb::object, py_object_lt>(m, "quantiles_items_sketch");
 }
@@ -27,6 +27,7 @@
 
 #include "py_object_lt.hpp"
 #include "py_object_ostream.hpp"
+#include "gil_release.hpp"
 #include "quantile_conditional.hpp"
 #include "req_sketch.hpp"
 
@@ -36,7 +37,11 @@ template<typename T, typename C>
 void bind_req_sketch(nb::module_ &m, const char* name) {
   using namespace datasketches;
 
-  auto req_class = nb::class_<req_sketch<T, C>>(m, name)
+  auto req_class = nb::class_<req_sketch<T, C>>(m, name);
+  // numpy overloads come first, as the list versions would also accept arrays
+  add_vector_queries<T>(req_class);
+
+  req_class
     .def(nb::init<uint16_t, bool>(), nb::arg("k")=12, nb::arg("is_hra")=true,
          "Creates an REQ sketch instance with the given value of k.\n\n"
          ":param k: Controls the size/accuracy trade-off of the sketch. Default is 12.\n"
@@ -69,7 +74,12 @@ void bind_req_sketch(nb::module_ &m, const char* name) {
         "Returns the minimum value from the stream. If empty, req_floats_sketch returns nan; req_ints_sketch throws a RuntimeError")
     .def("get_max_value", &req_sketch<T, C>::get_max_item,
         "Returns the maximum value from the stream. If empty, req_floats_sketch returns nan; req_ints_sketch throws a RuntimeError")
-    .def("get_quantile", &req_sketch<T, C>::get_quantile, nb::arg("rank"), nb::arg("inclusive")=false,
+    .def("get_quantile",
+        [](const req_sketch<T, C>& sk, double rank, bool inclusive) {
+          prepare_sorted_view<T>(sk);
+          return sk.get_quantile(rank, inclusive);
+        },
+        nb::arg("rank"), nb::arg("inclusive")=false,
         "Returns an approximation to the data value "
         "associated with the given normalized rank in a hypothetical sorted "
         "version of the input stream so far.\n"
@@ -78,6 +88,7 @@ void bind_req_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_quantiles",
         [](const req_sketch<T, C>& sk, const std::vector<double>& ranks, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           std::vector<T> quantiles;
           if (!sk.is_empty()) {
             quantiles.reserve(ranks.size());
@@ -90,7 +101,12 @@ void bind_req_sketch(nb::module_ &m, const char* name) {
         "normalized rank separately.\n"
         "If the sketch is empty this returns an empty vector."
     )
-    .def("get_rank", &req_sketch<T, C>::get_rank, nb::arg("value"), nb::arg("inclusive")=false,
+    .def("get_rank",
+        [](const req_sketch<T, C>& sk, const T& value, bool inclusive) {
+          prepare_sorted_view<T>(sk);
+          return sk.get_rank(value, inclusive);
+        },
+        nb::arg("value"), nb::arg("inclusive")=false,
         "Returns an approximation to the normalized rank of the given value from 0 to 1, inclusive.\n"
         "The resulting approximation has a probabilistic guarantee that can be obtained from the "
         "get_normalized_rank_error(False) function.\n"
@@ -100,6 +116,7 @@ void bind_req_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_pmf",
         [](const req_sketch<T, C>& sk, const std::vector<T>& split_points, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           return sk.get_PMF(split_points.data(), split_points.size(), inclusive);
         },
         nb::arg("split_points"), nb::arg("inclusive")=false,
@@ -120,6 +137,7 @@ void bind_req_sketch(nb::module_ &m, const char* name) {
     .def(
         "get_cdf",
         [](const req_sketch<T, C>& sk, const std::vector<T>& split_points, bool inclusive) {
+          prepare_sorted_view<T>(sk);
           return sk.get_CDF(split_points.data(), split_points.size(), inclusive);
         },
         nb::arg("split_points"), nb::arg("inclusive")=false,
@@ -164,11 +182,18 @@ void bind_req_sketch(nb::module_ &m, const char* name) {
     ;
 
     add_serialization<T>(req_class);
-    add_vector_update<T>(req_class);
+    add_vector_update<T>(req_class, [](const req_sketch<T, C>& sk) {
+      return req_sketch<T, C>(sk.get_k(), sk.is_HRA(), sk.get_comparator());
+    });
+    add_sorted_view<T>(req_class);
 }
 
 void init_req(nb::module_ &m) {
   bind_req_sketch<int, std::less<int>>(m, "req_ints_sketch");
   bind_req_sketch<float, std::less<float>>(m, "req_floats_sketch");
+  bind_req_sketch<double, std::less<double>>(m, "req_doubles_sketch");
+  bind_req_sketch<int64_t, std::less<int64_t>>(m, "req_longs_sketch");
+  bind_req_sketch<uint64_t, std::less<uint64_t>>(m, "req_ulongs_sketch");
+  bind_req_sketch<std::string, std::less<std::string>>(m, "req_strings_sketch");
   bind_req_sketch<nb::object, py_object_lt>(m, "req_items_sketch");
 }
@@ -0,0 +1,160 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+
+#include <nanobind/nanobind.h>
+#include <nanobind/ndarray.h>
+#include <nanobind/stl/pair.h>
+
+#include "py_ndarray.hpp"
+
+#include "quantiles_sorted_view.hpp"
+
+namespace nb = nanobind;
+
+// The sorted view is an immutable snapshot of a sketch's retained items
+// and their cumulative weights. Nothing in it is modified by queries, so
+// it may be queried from many threads without holding the GIL.
+template<typename T>
+void bind_sorted_view(nb::module_ &m, const char* name) {
+  using namespace datasketches;
+  using SV = quantiles_sorted_view<T, std::less<T>, std::allocator<T>>;
+
+  nb::class_<SV>(m, name,
+    "An immutable snapshot of the items retained by a quantiles family sketch, sorted and paired with their "
+    "cumulative weights. Queries are answered by binary search without rebuilding anything, and the view "
+    "is unaffected by later updates to the sketch. Obtain a new view from the sketch to refresh it.")
+    .def("__len__", &SV::size,
+        "Returns the number of retained items")
+    .def("is_empty", &SV::is_empty,
+        "Returns True if the view has no items, otherwise False")
+    .def("get_quantile", &SV::get_quantile, nb::arg("rank"), nb::arg("inclusive")=false,
+        nb::call_guard<nb::gil_scoped_release>(),
+        "Returns the approximate quantile for the given normalized rank")
+    .def("get_rank", &SV::get_rank, nb::arg("value"), nb::arg("inclusive")=false,
+        nb::call_guard<nb::gil_scoped_release>(),
+        "Returns the approximate normalized rank of the given value")
+    .def(
+        "get_quantiles",
+        [](const SV& sv, nb::ndarray<const double, nb::ndim<1>, nb::device::cpu> ranks, bool inclusive) {
+          const double* in = ranks.data();
+          const int64_t stride = ranks.stride(0);
+          const size_t n = sv.is_empty() ? 0 : ranks.shape(0);
+          auto quantiles = make_numpy_array<T>(n);
+          T* out = quantiles.data();
+          {
+            nb::gil_scoped_release release;
+            for (size_t i = 0; i < n; ++i) out[i] = sv.get_quantile(in[i * stride], inclusive);
+          }
+          return quantiles;
+        },
+        nb::arg("ranks"), nb::arg("inclusive")=false,
+        "Returns a numpy array with the quantile for each normalized rank in the given numpy array.\n"
+        "If the view is empty this returns an empty array."
+    )
+    .def(
+        "get_ranks",
+        [](const SV& sv, nb::ndarray<const T, nb::ndim<1>, nb::device::cpu> values, bool inclusive) {
+          const T* in = values.data();
+          const int64_t stride = values.stride(0);
+          const size_t n = sv.is_empty() ? 0 : values.shape(0);
+          auto ranks = make_numpy_array<double>(n);
+          double* out = ranks.data();
+          {
+            nb::gil_scoped_release release;
+            for (size_t i = 0; i < n; ++i) out[i] = sv.get_rank(in[i * stride], inclusive);
+          }
+          return ranks;
+        },
+        nb::arg("values"), nb::arg("inclusive")=false,
+        "Returns a numpy array with the normalized rank of each value in the given numpy array.\n"
+        "If the view is empty this returns an empty array."
+    )
+    .def(
+        "get_pmf",
+        [](const SV& sv, nb::ndarray<const T, nb::ndim<1>, nb::c_contig, nb::device::cpu> split_points, bool inclusive) {
+          const size_t num_points = split_points.shape(0);
+          auto pmf = make_numpy_array<double>(sv.is_empty() ? 0 : num_points + 1);
+          {
+            nb::gil_scoped_release release;
+            if (!sv.is_empty()) {
+              const auto result = sv.get_PMF(split_points.data(), static_cast<uint32_t>(num_points), inclusive);
+              std::copy(result.begin(), result.end(), pmf.data());
+            }
+          }
+          return pmf;
+        },
+        nb::arg("split_points"), nb::arg("inclusive")=false,
+        "Returns a numpy array approximating the Probability Mass Function (PMF) for the split points "
+        "in the given numpy array, which must be unique and monotonically increasing.\n"
+        "If the view is empty this returns an empty array."
+    )
+    .def(
+        "get_cdf",
+        [](const SV& sv, nb::ndarray<const T, nb::ndim<1>, nb::c_contig, nb::device::cpu> split_points, bool inclusive) {
+          const size_t num_points = split_points.shape(0);
+          auto cdf = make_numpy_array<double>(sv.is_empty() ? 0 : num_points + 1);
+          {
+            nb::gil_scoped_release release;
+            if (!sv.is_empty()) {
+              const auto result = sv.get_CDF(split_points.data(), static_cast<uint32_t>(num_points), inclusive);
+              std::copy(result.begin(), result.end(), cdf.data());
+            }
+          }
+          return cdf;
+        },
+        nb::arg("split_points"), nb::arg("inclusive")=false,
+        "Returns a numpy array approximating the Cumulative Distribution Function (CDF) for the split points "
+        "in the given numpy array, which must be unique and monotonically increasing.\n"
+        "If the view is empty this returns an empty array."
+    )
+    .def(
+        "to_numpy",
+        [](const SV& sv) {
+          auto items = make_numpy_array<T>(sv.size());
+          auto weights = make_numpy_array<uint64_t>(sv.size());
+          T* item_out = items.data();
+          uint64_t* weight_out = weights.data();
+          {
+            nb::gil_scoped_release release;
+            size_t i = 0;
+            for (auto it = sv.begin(); it != sv.end(); ++it, ++i) {
+              item_out[i] = (*it).first;
+              weight_out[i] = it.get_cumulative_weight(true);
+            }
+          }
+          return std::make_pair(items, weights);
+        },
+        "Returns a tuple of two numpy arrays: the sorted items, and for each item the total weight of "
+        "the items up to and including it"
+    );
+}
+
+void init_sorted_view(nb::module_ &m) {
+  bind_sorted_view<int>(m, "ints_sorted_view");
+  bind_sorted_view<float>(m, "floats_sorted_view");
+  bind_sorted_view<double>(m, "doubles_sorted_view");
+  bind_sorted_view<int64_t>(m, "longs_sorted_view");
+  bind_sorted_view<uint64_t>(m, "ulongs_sorted_view");
+}
@@ -20,6 +20,13 @@
 #include <vector>
 #include <stdexcept>
 #include <algorithm> // should ultimately be in tdigest.hpp
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
 
 #include <nanobind/nanobind.h>
 #include <nanobind/make_iterator.h>
@@ -28,10 +35,94 @@
 #include <nanobind/ndarray.h>
 
 #include "tdigest.hpp"
+#include "gil_release.hpp"
 #include "quantile_conditional.hpp"
+#include "py_ndarray.hpp"
 
 namespace nb = nanobind;
 
+// The layout written by tdigest::serialize() in tdigest_impl.hpp for a digest
+// of several centroids and no buffer, which tdigest_from_centroids() follows:
+// preamble longs (2), serial version, family, k (uint16), flags, 2 unused bytes,
+// then the number of centroids and of buffered values (uint32 each), min, max
+// and the centroids as stored in memory.
+namespace tdigest_layout {
+  static const uint8_t PREAMBLE_LONGS_MULTIPLE = 2;
+  static const uint8_t SERIAL_VERSION = 1;
+  static const uint8_t FAMILY = 20;
+  static const size_t HEADER_BYTES = 8;
+}
+
+// Builds a t-digest holding the given (mean, weight) centroids, so that merge()
+// can fold them into another digest in one pass. The sketch has no public way
+// to add a weighted value, so the centroids are written in its own serialized
+// layout, behind the header of a digest of the same k, and deserialized.
+template<typename T>
+datasketches::tdigest<T> tdigest_from_centroids(uint16_t k, const T* means, int64_t means_stride,
+                                                const double* weights, int64_t weights_stride, size_t n) {
+  using namespace datasketches;
+  using centroid = typename tdigest<T>::centroid;
+  using W = std::decay_t<decltype(std::declval<const centroid&>().get_weight())>;
+
+  std::vector<centroid> centroids;
+  centroids.reserve(n);
+  uint64_t total_weight = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const T mean = means[i * means_stride];
+    const double weight = weights[i * weights_stride];
+    if (!(weight >= 0) || std::floor(weight) != weight || weight >= static_cast<double>(std::numeric_limits<W>::max())) {
+      throw std::invalid_argument("weights must be non-negative integers: " + std::to_string(weight));
+    }
+    // as in update(), NaN values are ignored
+    if (std::isnan(mean) || weight == 0) continue;
+    const W w = static_cast<W>(weight);
+    if (total_weight > std::numeric_limits<uint64_t>::max() - w) {
+      throw std::invalid_argument("total weight of the centroids exceeds the capacity of the sketch");
+    }
+    centroids.push_back(centroid(mean, w));
+    total_weight += w;
+  }
+  std::stable_sort(centroids.begin(), centroids.end(), [](const centroid& a, const centroid& b) {
+    return a.get_mean() < b.get_mean();
+  });
+
+  tdigest<T> result(k);
+  // a single value of weight one is serialized differently
+  if (total_weight <= 1) {
+    if (total_weight == 1) result.update(centroids.front().get_mean());
+    return result;
+  }
+
+  // k and flags are taken from a digest with several centroids, after
+  // checking that the library still writes the layout described above
+  using namespace tdigest_layout;
+  result.update(0);
+  result.update(1);
+  const auto header = result.serialize();
+  if (header.size() < HEADER_BYTES || header[0] != PREAMBLE_LONGS_MULTIPLE
+      || header[1] != SERIAL_VERSION || header[2] != FAMILY) {
+    throw std::runtime_error("unsupported t-digest serialization layout, cannot build a digest from centroids");
+  }
+
+  const uint32_t num_centroids = static_cast<uint32_t>(centroids.size());
+  const uint32_t num_buffered = 0;
+  const T min = centroids.front().get_mean();
+  const T max = centroids.back().get_mean();
+  std::vector<char> bytes(HEADER_BYTES + 2 * sizeof(uint32_t) + 2 * sizeof(T) + num_centroids * sizeof(centroid));
+  char* ptr = bytes.data();
+  auto write = [&ptr](const void* src, size_t size) {
+    std::memcpy(ptr, src, size);
+    ptr += size;
+  };
+  write(header.data(), HEADER_BYTES);
+  write(&num_centroids, sizeof(num_centroids));
+  write(&num_buffered, sizeof(num_buffered));
+  write(&min, sizeof(min));
+  write(&max, sizeof(max));
+  write(centroids.data(), num_centroids * sizeof(centroid));
+  return tdigest<T>::deserialize(bytes.data(), bytes.size());
+}
+
 template<typename T>
 void bind_tdigest(nb::module_ &m, const char* name) {
   using namespace datasketches;
@@ -63,18 +154,57 @@ void bind_tdigest(nb::module_ &m, const char* name) {
          "Returns the minimum value from the stream. If empty, throws a RuntimeError")
     .def("get_max_value", &tdigest<T>::get_max_value,
          "Returns the maximum value from the stream. If empty, throws a RuntimeError")
-    .def("get_rank", &tdigest<T>::get_rank, nb::arg("value"),
+    .def("get_rank",
+         [](const tdigest<T>& sk, T value) {
+           prepare_sorted_view<T>(sk);
+           return sk.get_rank(value);
+         },
+         nb::arg("value"),
          "Computes the approximate normalized rank of the given value")
-    .def("get_quantile", &tdigest<T>::get_quantile, nb::arg("rank"),
+    .def("get_quantile",
+         [](const tdigest<T>& sk, double rank) {
+           prepare_sorted_view<T>(sk);
+           return sk.get_quantile(rank);
+         },
+         nb::arg("rank"),
          "Returns an approximation to the data value "
          "associated with the given rank in a hypothetical sorted "
          "version of the input stream so far.\n")
+    .def("get_quantiles",
+         [](const tdigest<T>& sk, nb::ndarray<const double, nb::ndim<1>, nb::device::cpu> ranks) {
+           prepare_sorted_view<T>(sk);
+           const double* in = ranks.data();
+           const int64_t stride = ranks.stride(0);
+           const size_t n = sk.is_empty() ? 0 : ranks.shape(0);
+           auto quantiles = make_numpy_array<T>(n);
+           T* out = quantiles.data();
+           for (size_t i = 0; i < n; ++i) out[i] = sk.get_quantile(in[i * stride]);
+           return quantiles;
+         },
+         nb::arg("ranks"),
+         "Returns a numpy array with the quantile for each normalized rank in the given numpy array.\n"
+         "If the sketch is empty this returns an empty array.")
+    .def("get_ranks",
+         [](const tdigest<T>& sk, nb::ndarray<const T, nb::ndim<1>, nb::device::cpu> values) {
+           prepare_sorted_view<T>(sk);
+           const T* in = values.data();
+           const int64_t stride = values.stride(0);
+           const size_t n = sk.is_empty() ? 0 : values.shape(0);
+           auto ranks = make_numpy_array<double>(n);
+           double* out = ranks.data();
+           for (size_t i = 0; i < n; ++i) out[i] = sk.get_rank(in[i * stride]);
+           return ranks;
+         },
+         nb::arg("values"),
+         "Returns a numpy array with the approximate normalized rank of each value in the given numpy array.\n"
+         "If the sketch is empty this returns an empty array.")
     .def("get_serialized_size_bytes", &tdigest<T>::get_serialized_size_bytes,
          nb::arg("with_buffer")=false,
          "Returns the size of the serialized sketch, in bytes")
     .def(
         "get_pmf",
         [](const tdigest<T>& sk, const std::vector<T>& split_points) {
+          prepare_sorted_view<T>(sk);
           return sk.get_PMF(split_points.data(), split_points.size());
         },
         nb::arg("split_points"),
@@ -88,6 +218,7 @@ void bind_tdigest(nb::module_ &m, const char* name) {
     .def(
         "get_cdf",
         [](const tdigest<T>& sk, const std::vector<T>& split_points) {
+          prepare_sorted_view<T>(sk);
           return sk.get_CDF(split_points.data(), split_points.size());
         },
         nb::arg("split_points"),
@@ -101,7 +232,32 @@ void bind_tdigest(nb::module_ &m, const char* name) {
     ;
 
     add_serialization<T>(tdigest_class);
-    add_vector_update<T>(tdigest_class);
+    add_vector_update<T>(tdigest_class, [](const tdigest<T>& sk) {
+      return tdigest<T>(sk.get_k());
+    });
+    tdigest_class.def("update",
+        [](tdigest<T>& sk, nb::ndarray<const T, nb::ndim<1>, nb::device::cpu> values,
+           nb::ndarray<const double, nb::ndim<1>, nb::device::cpu> weights) {
+          if (values.shape(0) != weights.shape(0)) {
+            throw std::invalid_argument("values and weights must have the same length: "
+              + std::to_string(values.shape(0)) + " and " + std::to_string(weights.shape(0)));
+          }
+          const uint16_t k = sk.get_k();
+          std::optional<tdigest<T>> centroids;
+          {
+            nb::gil_scoped_release release;
+            centroids.emplace(tdigest_from_centroids<T>(k, values.data(), values.stride(0),
+                                                        weights.data(), weights.stride(0), values.shape(0)));
+          }
+          sk.merge(*centroids);
+        },
+        nb::arg("values"), nb::arg("weights"),
+        "Updates the sketch with pre-aggregated centroids, such as those exported by another t-digest, "
+        "where values[i] is the mean of a centroid holding weights[i] items. The centroids are merged "
+        "into the sketch in a single pass, as with merge().\n\n"
+        ":param values: the centroid means\n:type values: numpy array\n"
+        ":param weights: the centroid weights, which must be non-negative integers\n:type weights: numpy array"
+    );
 }
 
 void init_tdigest(nb::module_ &m) {
@@ -29,6 +29,9 @@
 #include "theta_a_not_b.hpp"
 #include "theta_jaccard_similarity.hpp"
 #include "common_defs.hpp"
+#include "py_buffer.hpp"
+#include "py_output_buffer.hpp"
+#include "hash_vector_update.hpp"
 
 namespace nb = nanobind;
 
@@ -70,7 +73,7 @@ void init_theta(nb::module_ &m) {
      )
   ;
 
-  nb::class_<update_theta_sketch, theta_sketch>(m, "update_theta_sketch")
+  auto update_theta_class = nb::class_<update_theta_sketch, theta_sketch>(m, "update_theta_sketch")
     .def("__init__",
         [](update_theta_sketch* sk, uint8_t lg_k, double p, uint64_t seed) {
           new (sk) update_theta_sketch(update_theta_sketch::builder().set_lg_k(lg_k).set_p(p).set_seed(seed).build());
@@ -93,6 +96,8 @@ void init_theta(nb::module_ &m) {
     .def("trim", &update_theta_sketch::trim, "Removes retained entries in excess of the nominal size k (if any)")
     .def("reset", &update_theta_sketch::reset, "Resets the sketch to the initial empty state")
   ;
+  add_hash_vector_updates(update_theta_class);
+  add_string_vector_updates(update_theta_class);
 
   nb::class_<compact_theta_sketch, theta_sketch>(m, "compact_theta_sketch")
     .def(nb::init<const theta_sketch&, bool>(),
@@ -105,18 +110,37 @@ void init_theta(nb::module_ &m) {
     .def(
         "serialize",
         [](const compact_theta_sketch& sk, bool compress) {
-          auto bytes = compress ? sk.serialize_compressed() : sk.serialize();
-          return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+          return serialize_to_bytes(sk.get_serialized_size_bytes(compress), [&sk, compress](std::ostream& os) {
+            if (compress) sk.serialize_compressed(os);
+            else sk.serialize(os);
+          });
         }, nb::arg("compress")=false,
         "Serializes the sketch into a bytes object, optionally compressing the data"
     )
+    .def("get_serialized_size_bytes", &compact_theta_sketch::get_serialized_size_bytes, nb::arg("compress")=false,
+         "Returns the size of the serialized sketch, in bytes, optionally compressing the data")
+    .def(
+        "serialize_into",
+        [](const compact_theta_sketch& sk, nb::handle buffer, size_t offset, bool compress) {
+          return serialize_into(buffer, offset, sk.get_serialized_size_bytes(compress), [&sk, compress](std::ostream& os) {
+            if (compress) sk.serialize_compressed(os);
+            else sk.serialize(os);
+          });
+        },
+        nb::arg("buffer"), nb::arg("offset")=0, nb::arg("compress")=false,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset "
+        "and optionally compressing the data. Returns the number of bytes written."
+    )
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes, uint64_t seed) {
-          return compact_theta_sketch::deserialize(bytes.c_str(), bytes.size(), seed);
+        [](nb::handle bytes, uint64_t seed, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
+          nb::gil_scoped_release release;
+          return compact_theta_sketch::deserialize(buffer.data(), buffer.size(), seed);
         },
-        nb::arg("bytes"), nb::arg("seed")=DEFAULT_SEED,
-        "Reads a bytes object and returns the corresponding compact_theta_sketch"
+        nb::arg("bytes"), nb::arg("seed")=DEFAULT_SEED, nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+        "and returns the corresponding compact_theta_sketch"
     );
 
   nb::class_<theta_union>(m, "theta_union")
@@ -134,6 +158,20 @@ void init_theta(nb::module_ &m) {
          "Updates the union with the given sketch")
     .def("get_result", &theta_union::get_result, nb::arg("ordered")=true,
          "Returns the sketch corresponding to the union result")
+    .def(
+        "update_serialized",
+        [](theta_union& u, nb::handle buffers, uint64_t seed) {
+          auto views = get_buffers(buffers);
+          for (const auto& view: views) {
+            u.update(wrapped_compact_theta_sketch::wrap(view.data(), view.size(), seed));
+          }
+        },
+        nb::arg("buffers"), nb::arg("seed")=DEFAULT_SEED,
+        "Updates the union with each of the given serialized compact theta sketches, reading them in place "
+        "without creating intermediate Python objects.\n\n"
+        ":param buffers: serialized sketches\n:type buffers: list of bytes-like objects\n"
+        ":param seed: the seed used when hashing values. Must match all sketch seeds\n:type seed: int, optional"
+    )
   ;
 
   nb::class_<theta_intersection>(m, "theta_intersection")
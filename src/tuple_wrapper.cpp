@@ -26,6 +26,8 @@
 #include <nanobind/stl/function.h>
 #include <nanobind/stl/string.h>
 
+#include "py_buffer.hpp"
+#include "py_output_buffer.hpp"
 #include "py_serde.hpp"
 #include "py_object_ostream.hpp"
 #include "tuple_policy.hpp"
@@ -134,6 +136,26 @@ void init_tuple(nb::module_ &m) {
         }, nb::arg("serde"),
         "Serializes the sketch into a bytes object"
     )
+    .def(
+        "get_serialized_size_bytes",
+        [](const py_compact_tuple& sk, py_object_serde& serde) {
+          return count_serialized_bytes([&sk, &serde](std::ostream& os) { sk.serialize(os, serde); });
+        }, nb::arg("serde"),
+        "Computes the size in bytes needed to serialize the current sketch with the provided serde. "
+        "This costs as much as serializing since every summary needs to be converted."
+    )
+    .def(
+        "serialize_into",
+        [](const py_compact_tuple& sk, nb::handle buffer, py_object_serde& serde, size_t offset) {
+          const size_t size = count_serialized_bytes([&sk, &serde](std::ostream& os) { sk.serialize(os, serde); });
+          return serialize_into(buffer, offset, size, [&sk, &serde](std::ostream& os) {
+            sk.serialize(os, serde);
+          });
+        },
+        nb::arg("buffer"), nb::arg("serde"), nb::arg("offset")=0,
+        "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset "
+        "and using the provided serde. Returns the number of bytes written."
+    )
     .def("filter",
          [](const py_compact_tuple& sk, const std::function<bool(const nb::object&)> func) {
            return sk.filter(func);
@@ -144,11 +166,14 @@ void init_tuple(nb::module_ &m) {
          ":return: A compact_tuple_sketch with the selected entries\n:rtype: :class:`compact_tuple_sketch`")
     .def_static(
         "deserialize",
-        [](const nb::bytes& bytes, py_object_serde& serde, uint64_t seed) {
-          return py_compact_tuple::deserialize(bytes.c_str(), bytes.size(), seed, serde);
+        [](nb::handle bytes, py_object_serde& serde, uint64_t seed, size_t offset, std::optional<size_t> length) {
+          py_buffer buffer(bytes, offset, length);
+          return py_compact_tuple::deserialize(buffer.data(), buffer.size(), seed, serde);
         },
         nb::arg("bytes"), nb::arg("serde"), nb::arg("seed")=DEFAULT_SEED,
-        "Reads a bytes object and returns the corresponding compact_tuple_sketch"
+        nb::arg("offset")=0, nb::arg("length")=nb::none(),
+        "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+        "and returns the corresponding compact_tuple_sketch"
     );
 
   nb::class_<py_update_tuple, py_tuple_sketch>(m, "update_tuple_sketch")
@@ -17,7 +17,16 @@
  * under the License.
  */
 
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
 #include <functional>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <shared_mutex>
 #include <string>
 #include <sstream>
 #include <stdexcept>
@@ -31,6 +40,16 @@
 #include <nanobind/stl/string.h>
 
 #include "kll_sketch.hpp"
+#include "quantiles_sketch.hpp"
+#include "req_sketch.hpp"
+#include "tdigest.hpp"
+#include "memory_operations.hpp"
+#include "ks_batch.hpp"
+#include "parallel_reduce.hpp"
+#include "py_buffer.hpp"
+#include "py_ndarray.hpp"
+#include "py_output_buffer.hpp"
+#include "sketch_arena.hpp"
 
 namespace nb = nanobind;
 
@@ -39,21 +58,145 @@ namespace datasketches {
 namespace vector_of_kll_constants {
   static const uint32_t DEFAULT_K = kll_constants::DEFAULT_K;
   static const uint32_t DEFAULT_D = 1;
+  // updates are read in tiles of this many rows and columns
+  static const size_t UPDATE_TILE_ROWS = 512;
+  static const uint32_t UPDATE_TILE_COLS = 16;
+  // bulk serialization format, see serialize_all()
+  static const uint32_t BLOB_MAGIC = 0x4C4B4C56; // "VLKL" in little-endian byte order
+  static const uint8_t BLOB_SERIAL_VERSION = 1;
+  static const size_t BLOB_HEADER_BYTES = 16;
+}
+
+// Describes how vector_of_sketches creates, queries and deserializes
+// each family of quantile sketches.
+// KLL, REQ and classic quantiles sketches are queried through a sorted view.
+template<typename SK> struct vector_sketch_traits;
+
+template<typename SK, typename T, typename C, typename A, typename DefaultSK>
+struct sorted_view_sketch_traits {
+  using item_type = T;
+  using allocator_type = A;
+  // the type bound to Python, using the default allocator
+  using default_sketch = DefaultSK;
+
+  static SK deserialize(const void* bytes, size_t size, const A& allocator) {
+    return SK::deserialize(bytes, size, serde<T>(), C(), allocator);
+  }
+  static T get_min_item(const SK& sk) { return sk.get_min_item(); }
+  static T get_max_item(const SK& sk) { return sk.get_max_item(); }
+  static uint64_t get_n(const SK& sk) { return sk.get_n(); }
+  static auto get_query_view(const SK& sk) { return sk.get_sorted_view(); }
+  static std::string to_string(const SK& sk, bool print_levels, bool print_items) {
+    return sk.to_string(print_levels, print_items);
+  }
+};
+
+template<typename T, typename C, typename A>
+struct vector_sketch_traits<kll_sketch<T, C, A>>:
+sorted_view_sketch_traits<kll_sketch<T, C, A>, T, C, A, kll_sketch<T, C>> {
+  static const uint8_t FAMILY_ID = 15;
+  static kll_sketch<T, C, A> make(const A& allocator, uint16_t k) {
+    return kll_sketch<T, C, A>(k, C(), allocator);
+  }
+  static kll_sketch<T, C, A> make_like(const kll_sketch<T, C, A>& sk, const A& allocator) {
+    return kll_sketch<T, C, A>(sk.get_k(), sk.get_comparator(), allocator);
+  }
+};
+
+template<typename T, typename C, typename A>
+struct vector_sketch_traits<quantiles_sketch<T, C, A>>:
+sorted_view_sketch_traits<quantiles_sketch<T, C, A>, T, C, A, quantiles_sketch<T, C>> {
+  static const uint8_t FAMILY_ID = 8;
+  static quantiles_sketch<T, C, A> make(const A& allocator, uint16_t k) {
+    return quantiles_sketch<T, C, A>(k, C(), allocator);
+  }
+  static quantiles_sketch<T, C, A> make_like(const quantiles_sketch<T, C, A>& sk, const A& allocator) {
+    return quantiles_sketch<T, C, A>(sk.get_k(), sk.get_comparator(), allocator);
+  }
+};
+
+template<typename T, typename C, typename A>
+struct vector_sketch_traits<req_sketch<T, C, A>>:
+sorted_view_sketch_traits<req_sketch<T, C, A>, T, C, A, req_sketch<T, C>> {
+  static const uint8_t FAMILY_ID = 17;
+  static req_sketch<T, C, A> make(const A& allocator, uint16_t k, bool hra) {
+    return req_sketch<T, C, A>(k, hra, C(), allocator);
+  }
+  static req_sketch<T, C, A> make_like(const req_sketch<T, C, A>& sk, const A& allocator) {
+    return req_sketch<T, C, A>(sk.get_k(), sk.is_HRA(), sk.get_comparator(), allocator);
+  }
+};
+
+// t-digest is queried directly, and has no choice of inclusive ranks
+template<typename T, typename A>
+struct tdigest_query_view {
+  const tdigest<T, A>& sk;
+  T get_quantile(double rank, bool) const { return sk.get_quantile(rank); }
+  double get_rank(T item, bool) const { return sk.get_rank(item); }
+  auto get_PMF(const T* split_points, uint32_t size, bool) const { return sk.get_PMF(split_points, size); }
+  auto get_CDF(const T* split_points, uint32_t size, bool) const { return sk.get_CDF(split_points, size); }
+};
+
+template<typename T, typename A>
+struct vector_sketch_traits<tdigest<T, A>> {
+  using item_type = T;
+  using allocator_type = A;
+  using default_sketch = tdigest<T>;
+  static const uint8_t FAMILY_ID = 20;
+
+  static tdigest<T, A> make(const A& allocator, uint16_t k) { return tdigest<T, A>(k, allocator); }
+  static tdigest<T, A> make_like(const tdigest<T, A>& sk, const A& allocator) {
+    return tdigest<T, A>(sk.get_k(), allocator);
+  }
+  static tdigest<T, A> deserialize(const void* bytes, size_t size, const A& allocator) {
+    return tdigest<T, A>::deserialize(bytes, size, allocator);
+  }
+  static T get_min_item(const tdigest<T, A>& sk) { return sk.get_min_value(); }
+  static T get_max_item(const tdigest<T, A>& sk) { return sk.get_max_value(); }
+  static uint64_t get_n(const tdigest<T, A>& sk) { return sk.get_total_weight(); }
+  static tdigest_query_view<T, A> get_query_view(const tdigest<T, A>& sk) { return tdigest_query_view<T, A>{sk}; }
+  static std::string to_string(const tdigest<T, A>& sk, bool, bool print_items) {
+    return sk.to_string(print_items);
+  }
+};
+
+// Acquires the given locks, releasing the GIL while waiting, so that a
+// thread holding one of them can always take the GIL.
+template<typename... Locks>
+void lock_without_gil(Locks&... locks) {
+  nb::gil_scoped_release release;
+  if constexpr (sizeof...(Locks) == 1) (locks.lock(), ...);
+  else std::lock(locks...);
 }
 
 // Wrapper class for Numpy compatibility
-template <typename T, typename C = std::less<T>>
-class vector_of_kll_sketches {
+// All sketches in the vector share a copy of one allocator. With
+// arena_allocator they draw from a common arena, which is compacted
+// after merges that leave much of it unused.
+// The sketches are guarded by a shared mutex: methods that only read them
+// share it, while those that modify the vector or a sketch hold it
+// exclusively. Quantile queries, serialization and Kolmogorov-Smirnov tests
+// count as modifications, since they may sort level zero of a KLL sketch
+// or merge the buffer of a t-digest.
+template <typename SK>
+class vector_of_sketches {
   public:
-    explicit vector_of_kll_sketches(uint32_t k = vector_of_kll_constants::DEFAULT_K, uint32_t d = vector_of_kll_constants::DEFAULT_D);
-    vector_of_kll_sketches(const vector_of_kll_sketches& other);
-    vector_of_kll_sketches(vector_of_kll_sketches&& other) noexcept;
-    vector_of_kll_sketches<T, C>& operator=(const vector_of_kll_sketches& other);
-    vector_of_kll_sketches<T, C>& operator=(vector_of_kll_sketches&& other);
+    using traits = vector_sketch_traits<SK>;
+    using T = typename traits::item_type;
+    using A = typename traits::allocator_type;
+    using default_sketch = typename traits::default_sketch;
+
+    // sketch_args configure each sketch, as for traits::make()
+    template<typename... Args>
+    explicit vector_of_sketches(uint32_t d, Args... sketch_args);
+    vector_of_sketches(const vector_of_sketches& other);
+    vector_of_sketches(vector_of_sketches&& other) noexcept;
+    vector_of_sketches<SK>& operator=(const vector_of_sketches& other);
+    vector_of_sketches<SK>& operator=(vector_of_sketches&& other);
 
     // container parameters
     inline uint32_t get_k() const;
-    inline uint32_t get_d() const;
+    uint32_t get_d() const;
 
     template<typename V>
     using Array1D = nb::ndarray<V, nb::numpy, nb::ndim<1>>;
@@ -62,14 +205,29 @@ class vector_of_kll_sketches {
     using Array2D = nb::ndarray<V, nb::numpy, nb::ndim<2>, nb::c_contig>;
 
     // sketch updates/merges
-    void update(nb::ndarray<T>& items, char order);
-    void merge(const vector_of_kll_sketches<T>& other);
+    void update(nb::ndarray<T>& items, char order, unsigned num_threads);
+    void update_grouped(const nb::ndarray<const int64_t, nb::ndim<1>, nb::device::cpu>& group_ids,
+                        const nb::ndarray<const T, nb::ndim<1>, nb::device::cpu>& items);
+    void merge(const vector_of_sketches<SK>& other);
+
+    // copies every sketch into freshly allocated memory, releasing any
+    // space left unused by earlier updates and merges
+    void compact();
+    // memory drawn from the shared arena, for arena_allocator only
+    size_t get_allocated_bytes() const;
+    size_t get_reserved_bytes() const;
+
+    // appends empty sketches, returning the new number of dimensions
+    uint32_t add_dimensions(uint32_t n);
+
+    // Kolmogorov-Smirnov tests between matching sketches, see ks_test_pairs()
+    nb::tuple ks_test(const vector_of_sketches<SK>& other, double p, unsigned num_threads) const;
 
     template<typename V>
     using ArrInputType = std::variant<nb::ndarray<>, nb::list, V>;
 
     // returns a single sketch combining all data in the array
-    kll_sketch<T, C> collapse(ArrInputType<int>& isk) const;
+    default_sketch collapse(ArrInputType<int>& isk) const;
 
     // sketch queries returning an array of results
     Array1D<bool> is_empty() const;
@@ -78,10 +236,14 @@ class vector_of_kll_sketches {
     Array1D<T> get_min_values() const;
     Array1D<T> get_max_values() const;
     Array1D<uint32_t> get_num_retained() const;
-    Array2D<T> get_quantiles(ArrInputType<double>& ranks, ArrInputType<int>& isk) const;
-    Array2D<double> get_ranks(ArrInputType<T>& values, ArrInputType<int>& isk) const;
-    Array2D<double> get_pmf(ArrInputType<T>& split_points, ArrInputType<int>& isk) const;
-    Array2D<double> get_cdf(ArrInputType<T>& split_points, ArrInputType<int>& isk) const;
+    Array2D<T> get_quantiles(ArrInputType<double>& ranks, ArrInputType<int>& isk,
+                             bool inclusive, unsigned num_threads) const;
+    Array2D<double> get_ranks(ArrInputType<T>& values, ArrInputType<int>& isk,
+                              bool inclusive, unsigned num_threads) const;
+    Array2D<double> get_pmf(ArrInputType<T>& split_points, ArrInputType<int>& isk,
+                            bool inclusive, unsigned num_threads) const;
+    Array2D<double> get_cdf(ArrInputType<T>& split_points, ArrInputType<int>& isk,
+                            bool inclusive, unsigned num_threads) const;
 
     // human-readable output
     std::string to_string(bool print_levels = false, bool print_items = false) const;
@@ -90,12 +252,51 @@ class vector_of_kll_sketches {
     nb::list serialize(ArrInputType<int>& isk);
     // note: deserialize() replaces the sketch at the specified
     //       index. Not a static method.
-    void deserialize(const nb::bytes& sk_bytes, uint32_t idx);
+    void deserialize(nb::handle sk_bytes, uint32_t idx, size_t offset, const std::optional<size_t>& length);
+
+    // all sketches as a single blob, with an offset table for random access
+    nb::bytes serialize_all() const;
+    static vector_of_sketches<SK> deserialize_all(nb::handle bytes, size_t offset,
+        const std::optional<size_t>& length, unsigned num_threads);
+    // a single sketch from a blob, without reading the others
+    static default_sketch deserialize_sketch(nb::handle bytes, uint32_t idx, size_t offset,
+        const std::optional<size_t>& length);
 
   private:
+    vector_of_sketches(uint32_t k, std::vector<SK>&& sketches, const A& allocator);
+
+    // the parsed header of a bulk blob
+    struct blob_index {
+      uint32_t k;
+      uint32_t d;
+      const char* offsets;
+      const char* sketches;
+      size_t sketches_size;
+    };
+
+    static blob_index read_blob_index(const char* data, size_t size);
+    // the serialized bytes of one sketch in a blob
+    static std::pair<const char*, size_t> get_blob_sketch(const blob_index& index, uint32_t idx);
+
+    // a copy of the sketch using the default allocator, as bound to Python
+    static default_sketch to_default_allocator(SK&& sketch);
+    // compact() and compact_if_sparse() for callers holding the lock
+    void compact_locked();
+    void compact_if_sparse();
+
+    std::shared_lock<std::shared_mutex> read_lock() const;
+    std::unique_lock<std::shared_mutex> write_lock() const;
+
     template<typename TT>
     Array1D<TT> input_to_vec(ArrInputType<TT>& input) const;
 
+    template<typename TT>
+    std::vector<TT> input_to_std_vec(ArrInputType<TT>& input) const;
+
+    // fills one row of the result per requested sketch from its sorted view
+    template<typename TT, typename F>
+    Array2D<TT> query_sketches(ArrInputType<int>& isk, size_t num_cols, unsigned num_threads, F&& fill) const;
+
     Array1D<uint32_t> get_indices(Array1D<int>& isk) const;
     
     template<typename TT>
@@ -104,72 +305,114 @@ class vector_of_kll_sketches {
     template<typename TT>
     Array2D<TT> make_ndarray(size_t rows, size_t cols) const;
 
-    const uint32_t k_; // kll sketch k parameter
-    const uint32_t d_; // number of dimensions (here: sketches) to hold
-    std::vector<kll_sketch<T, C>> sketches_;
+    uint32_t k_; // sketch k parameter
+    uint32_t d_; // number of dimensions (here: sketches) to hold
+    A allocator_;
+    std::vector<SK> sketches_;
+    mutable std::shared_mutex mutex_;
 };
 
-template<typename T, typename C>
-vector_of_kll_sketches<T, C>::vector_of_kll_sketches(uint32_t k, uint32_t d):
-k_(k), 
-d_(d)
+template<typename SK>
+template<typename... Args>
+vector_of_sketches<SK>::vector_of_sketches(uint32_t d, Args... sketch_args):
+k_(0),
+d_(d),
+allocator_()
 {
-  // check d is valid (k is checked by kll_sketch)
+  // check d is valid (k is checked by the sketch)
   if (d < 1) {
     throw std::invalid_argument("D must be >= 1: " + std::to_string(d));
   }
 
   sketches_.reserve(d);
   // spawn the sketches
-  for (uint32_t i = 0; i < d; i++) {
-    sketches_.emplace_back(k);
+  sketches_.push_back(traits::make(allocator_, sketch_args...));
+  for (uint32_t i = 1; i < d; i++) {
+    sketches_.push_back(traits::make_like(sketches_[0], allocator_));
   }
+  k_ = sketches_[0].get_k();
 }
 
-template<typename T, typename C>
-vector_of_kll_sketches<T, C>::vector_of_kll_sketches(const vector_of_kll_sketches& other) :
-  k_(other.k_),
-  d_(other.d_),
-  sketches_(other.sketches_)
+template<typename SK>
+vector_of_sketches<SK>::vector_of_sketches(uint32_t k, std::vector<SK>&& sketches, const A& allocator):
+k_(k),
+d_(static_cast<uint32_t>(sketches.size())),
+allocator_(allocator),
+sketches_(std::move(sketches))
 {}
 
-template<typename T, typename C>
-vector_of_kll_sketches<T, C>::vector_of_kll_sketches(vector_of_kll_sketches&& other) noexcept :
+template<typename SK>
+vector_of_sketches<SK>::vector_of_sketches(const vector_of_sketches& other) :
+  k_(other.k_),
+  d_(0),
+  allocator_()
+{
+  auto lock = other.read_lock();
+  nb::gil_scoped_release release;
+  d_ = other.d_;
+  allocator_ = other.allocator_;
+  sketches_ = other.sketches_;
+  // the copy gets an arena of its own
+  compact_locked();
+}
+
+// moves are only made from vectors that no other thread can reach
+
+template<typename SK>
+vector_of_sketches<SK>::vector_of_sketches(vector_of_sketches&& other) noexcept :
   k_(other.k_),
   d_(other.d_),
+  allocator_(other.allocator_),
   sketches_(std::move(other.sketches_))
 {}
 
-template<typename T, typename C>
-vector_of_kll_sketches<T, C>& vector_of_kll_sketches<T, C>::operator=(const vector_of_kll_sketches& other) {
-  vector_of_kll_sketches<T, C> copy(other);
+template<typename SK>
+vector_of_sketches<SK>& vector_of_sketches<SK>::operator=(const vector_of_sketches& other) {
+  vector_of_sketches<SK> copy(other);
   k_ = copy.k_;
   d_ = copy.d_;
+  std::swap(allocator_, copy.allocator_);
   std::swap(sketches_, copy.sketches_);
   return *this;
 }
 
-template<typename T, typename C>
-vector_of_kll_sketches<T, C>& vector_of_kll_sketches<T, C>::operator=(vector_of_kll_sketches&& other) {
+template<typename SK>
+vector_of_sketches<SK>& vector_of_sketches<SK>::operator=(vector_of_sketches&& other) {
   k_ = other.k_;
   d_ = other.d_;
+  std::swap(allocator_, other.allocator_);
   std::swap(sketches_, other.sketches_);
   return *this;
 }
 
-template<typename T, typename C>
-uint32_t vector_of_kll_sketches<T, C>::get_k() const {
+template<typename SK>
+uint32_t vector_of_sketches<SK>::get_k() const {
   return k_;
 }
 
-template<typename T, typename C>
-uint32_t vector_of_kll_sketches<T, C>::get_d() const {
+template<typename SK>
+uint32_t vector_of_sketches<SK>::get_d() const {
+  auto lock = read_lock();
   return d_;
 }
 
-template<typename T, typename C>
+template<typename SK>
+std::shared_lock<std::shared_mutex> vector_of_sketches<SK>::read_lock() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+  lock_without_gil(lock);
+  return lock;
+}
+
+template<typename SK>
+std::unique_lock<std::shared_mutex> vector_of_sketches<SK>::write_lock() const {
+  std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+  lock_without_gil(lock);
+  return lock;
+}
+
+template<typename SK>
 template<typename TT>
-auto vector_of_kll_sketches<T, C>::make_ndarray(size_t size) const -> Array1D<TT> {
+auto vector_of_sketches<SK>::make_ndarray(size_t size) const -> Array1D<TT> {
   TT* data = new TT[size];
 
   nb::capsule owner(data, [](void *p) noexcept {
@@ -179,9 +422,9 @@ auto vector_of_kll_sketches<T, C>::make_ndarray(size_t size) const -> Array1D<TT
   return Array1D<TT>(data, {size}, owner);
 }
 
-template<typename T, typename C>
+template<typename SK>
 template<typename TT>
-auto vector_of_kll_sketches<T, C>::make_ndarray(size_t rows, size_t cols) const -> Array2D<TT> {
+auto vector_of_sketches<SK>::make_ndarray(size_t rows, size_t cols) const -> Array2D<TT> {
   TT* data = new TT[rows * cols];
 
   nb::capsule owner(data, [](void *p) noexcept {
@@ -191,9 +434,9 @@ auto vector_of_kll_sketches<T, C>::make_ndarray(size_t rows, size_t cols) const
   return Array2D<TT>(data, {rows, cols}, owner);
 }
 
-template<typename T, typename C>
+template<typename SK>
 template<typename TT>
-auto vector_of_kll_sketches<T, C>::input_to_vec(ArrInputType<TT>& input) const -> Array1D<TT> {
+auto vector_of_sketches<SK>::input_to_vec(ArrInputType<TT>& input) const -> Array1D<TT> {
   if (std::holds_alternative<nb::ndarray<>>(input)) {
     nb::ndarray<> arr = std::get<nb::ndarray<>>(input);
     return Array1D<TT>(arr);
@@ -212,8 +455,8 @@ auto vector_of_kll_sketches<T, C>::input_to_vec(ArrInputType<TT>& input) const -
   }
 }
 
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_indices(Array1D<int>& isk) const -> Array1D<uint32_t> {
+template<typename SK>
+auto vector_of_sketches<SK>::get_indices(Array1D<int>& isk) const -> Array1D<uint32_t> {
   auto input = isk.view<nb::ndim<1>>();
   size_t num_input = input.shape(0);
   Array1D<uint32_t> output;
@@ -244,8 +487,9 @@ auto vector_of_kll_sketches<T, C>::get_indices(Array1D<int>& isk) const -> Array
 }
 
 // Checks if each sketch is empty or not
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::is_empty() const -> Array1D<bool> {
+template<typename SK>
+auto vector_of_sketches<SK>::is_empty() const -> Array1D<bool> {
+  auto lock = read_lock();
   auto vals = make_ndarray<bool>(d_);
   auto view = vals.view();
   for (uint32_t i = 0; i < d_; ++i) {
@@ -257,93 +501,251 @@ auto vector_of_kll_sketches<T, C>::is_empty() const -> Array1D<bool> {
 // Updates each sketch with values
 // Currently: all values must be present
 // TODO: allow subsets of sketches to be updated
-template<typename T, typename C>
-void vector_of_kll_sketches<T, C>::update(nb::ndarray<T>& items, char order) {
-  size_t ndim = items.ndim();
-
+// The input is read through its strides in tiles spanning a few columns, each
+// transposed into a buffer so that both row- and column-major arrays are read
+// sequentially and every sketch is then fed a contiguous run of its values.
+// Groups of columns are spread across threads, so no two threads share a sketch.
+// The order argument is kept for compatibility; the layout comes from the array.
+template<typename SK>
+void vector_of_sketches<SK>::update(nb::ndarray<T>& items, char order, unsigned num_threads) {
+  unused(order);
+  auto lock = write_lock();
+  const size_t ndim = items.ndim();
+  if (ndim < 1 || ndim > 2) {
+    throw std::invalid_argument("Update input must be 2 or fewer dimensions : " + std::to_string(ndim));
+  }
   if (items.shape(ndim-1) != d_) {
     throw std::invalid_argument("input data must have rows with  " + std::to_string(d_)
           + " elements. Found: " + std::to_string(items.shape(ndim-1)));
   }
-  
-  if (ndim == 1) {
-    // 1D case: single value to update per sketch
-    const T* data = items.data();
-    for (uint32_t i = 0; i < d_; ++i) {
-      sketches_[i].update(data[i]);
-    }
-  }
-  else if (ndim == 2) {
-    // 2D case: multiple values to update per sketch
-    // We could speedthis up by using raw array access and pre-computing an offset for the
-    // row/column, but if we use the wrong ordering the computation would be incorrect.
-    // By using a view and dereferencing by (row, column) each time we ensure correct
-    // processing at the cost of an extra multiply each derference. Using a mismatched
-    // ordering versus the actual data storage will be potentially slower but will still
-    // produce correct output.
-    auto data = items.template view<nb::ndim<2>>();
-    if (order == 'F' || order == 'f') { // Fortran-style (column-major) order
-      for (uint32_t j = 0; j < d_; ++j) {
-        const size_t offset = j * d_;
-        for (uint32_t i = 0; i < items.shape(0); ++i) { 
-          sketches_[j].update(data(i, j));
+
+  // a 1D input is a single row
+  const size_t num_rows = ndim == 2 ? items.shape(0) : 1;
+  const int64_t row_stride = ndim == 2 ? items.stride(0) : 0;
+  const int64_t col_stride = items.stride(ndim - 1);
+  const T* data = items.data();
+
+  nb::gil_scoped_release release;
+  using namespace vector_of_kll_constants;
+  const uint32_t num_groups = (d_ + UPDATE_TILE_COLS - 1) / UPDATE_TILE_COLS;
+  num_threads = std::min(resolve_num_threads(num_threads), num_groups);
+  std::atomic<uint32_t> next(0);
+  run_in_threads(num_threads, [&](unsigned) {
+    std::vector<T> tile(UPDATE_TILE_ROWS * UPDATE_TILE_COLS);
+    for (uint32_t g = next++; g < num_groups; g = next++) {
+      const uint32_t first = g * UPDATE_TILE_COLS;
+      const uint32_t width = std::min(UPDATE_TILE_COLS, d_ - first);
+      for (size_t r = 0; r < num_rows; r += UPDATE_TILE_ROWS) {
+        const size_t height = std::min(UPDATE_TILE_ROWS, num_rows - r);
+        for (size_t i = 0; i < height; ++i) {
+          const T* row = data + static_cast<int64_t>(r + i) * row_stride + static_cast<int64_t>(first) * col_stride;
+          for (uint32_t j = 0; j < width; ++j) tile[j * UPDATE_TILE_ROWS + i] = row[j * col_stride];
         }
-      }
-    } else { // nb::c_contig or nb::any_contig
-      for (uint32_t i = 0; i < items.shape(0); ++i) { 
-        const size_t offset = i * items.shape(0);
-        for (uint32_t j = 0; j < d_; ++j) {
-          sketches_[j].update(data(i, j));
+        for (uint32_t j = 0; j < width; ++j) {
+          SK& sk = sketches_[first + j];
+          const T* column = tile.data() + j * UPDATE_TILE_ROWS;
+          for (size_t i = 0; i < height; ++i) {
+            // NaN marks a dimension without a value in this row
+            if constexpr (std::is_floating_point<T>::value) {
+              if (std::isnan(column[i])) continue;
+            }
+            sk.update(column[i]);
+          }
         }
       }
     }
+  });
+}
+
+// Updates sketch group_ids[i] with items[i], in a single pass over both arrays.
+// Every id is checked before any sketch is updated. NaN items are skipped.
+template<typename SK>
+void vector_of_sketches<SK>::update_grouped(const nb::ndarray<const int64_t, nb::ndim<1>, nb::device::cpu>& group_ids,
+                                            const nb::ndarray<const T, nb::ndim<1>, nb::device::cpu>& items) {
+  auto lock = write_lock();
+  nb::gil_scoped_release release;
+  const size_t n = items.shape(0);
+  if (group_ids.shape(0) != n) {
+    throw std::invalid_argument("group_ids and items must have the same length: "
+          + std::to_string(group_ids.shape(0)) + " vs " + std::to_string(n));
   }
-  else {
-    throw std::invalid_argument("Update input must be 2 or fewer dimensions : " + std::to_string(ndim));
+  const int64_t* ids = group_ids.data();
+  const int64_t ids_stride = group_ids.stride(0);
+  const T* data = items.data();
+  const int64_t items_stride = items.stride(0);
+
+  for (size_t i = 0; i < n; ++i) {
+    const int64_t id = ids[i * ids_stride];
+    if (id < 0 || id >= static_cast<int64_t>(d_)) {
+      throw std::invalid_argument("request for invalid dimensions >= d ("
+               + std::to_string(d_) +"): "+ std::to_string(id));
+    }
+  }
+  for (size_t i = 0; i < n; ++i) {
+    const T& item = data[i * items_stride];
+    if constexpr (std::is_floating_point<T>::value) {
+      if (std::isnan(item)) continue;
+    }
+    sketches_[ids[i * ids_stride]].update(item);
+  }
+}
+
+template<typename SK>
+uint32_t vector_of_sketches<SK>::add_dimensions(uint32_t n) {
+  auto lock = write_lock();
+  if (n > std::numeric_limits<uint32_t>::max() - d_) {
+    throw std::invalid_argument("too many dimensions: " + std::to_string(d_) + " + " + std::to_string(n));
+  }
+  sketches_.reserve(d_ + n);
+  for (uint32_t i = 0; i < n; ++i) {
+    sketches_.push_back(traits::make_like(sketches_[0], allocator_));
   }
+  d_ += n;
+  return d_;
+}
+
+template<typename SK>
+nb::tuple vector_of_sketches<SK>::ks_test(const vector_of_sketches<SK>& other, double p, unsigned num_threads) const {
+  // building the sorted views may sort level zero, so both sides are held exclusively
+  std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+  std::unique_lock<std::shared_mutex> other_lock;
+  if (&other == this) {
+    lock_without_gil(lock);
+  } else {
+    other_lock = std::unique_lock<std::shared_mutex>(other.mutex_, std::defer_lock);
+    lock_without_gil(lock, other_lock);
+  }
+  if (d_ != other.d_) {
+    throw std::invalid_argument("Must have same number of dimensions to test: " + std::to_string(d_)
+      + " and " + std::to_string(other.d_));
+  }
+  auto rejected = make_numpy_array<bool>(d_);
+  auto statistics = make_numpy_array<double>(d_);
+  {
+    nb::gil_scoped_release release;
+    std::vector<const SK*> pointers_1;
+    std::vector<const SK*> pointers_2;
+    for (const auto& sk: sketches_) pointers_1.push_back(&sk);
+    for (const auto& sk: other.sketches_) pointers_2.push_back(&sk);
+    ks_test_pairs(pointers_1, pointers_2, p, num_threads, rejected.data(), statistics.data());
+  }
+  return nb::make_tuple(rejected, statistics);
 }
 
 // Merges two arrays of sketches
 // Currently: all values must be present
-template<typename T, typename C>
-void vector_of_kll_sketches<T, C>::merge(const vector_of_kll_sketches<T>& other) {
-  if (d_ != other.get_d()) {
+template<typename SK>
+void vector_of_sketches<SK>::merge(const vector_of_sketches<SK>& other) {
+  if (&other == this) {
+    // the other side cannot be locked for reading while this one is written
+    const vector_of_sketches<SK> copy(other);
+    merge(copy);
+    return;
+  }
+  std::unique_lock<std::shared_mutex> lock(mutex_, std::defer_lock);
+  std::shared_lock<std::shared_mutex> other_lock(other.mutex_, std::defer_lock);
+  lock_without_gil(lock, other_lock);
+  if (d_ != other.d_) {
     throw std::invalid_argument("Must have same number of dimensions to merge: " + std::to_string(d_)
                                 + " vs " + std::to_string(other.d_));
   } else {
+    nb::gil_scoped_release release;
     for (uint32_t i = 0; i < d_; ++i) {
       sketches_[i].merge(other.sketches_[i]);
     }
+    compact_if_sparse();
+  }
+}
+
+template<typename SK>
+void vector_of_sketches<SK>::compact() {
+  auto lock = write_lock();
+  nb::gil_scoped_release release;
+  compact_locked();
+}
+
+template<typename SK>
+void vector_of_sketches<SK>::compact_locked() {
+  if constexpr (is_arena_allocator<A>::value) {
+    A allocator; // a new arena
+    std::vector<SK> compacted;
+    compacted.reserve(d_);
+    for (const auto& sk: sketches_) {
+      auto bytes = sk.serialize();
+      compacted.push_back(traits::deserialize(bytes.data(), bytes.size(), allocator));
+    }
+    sketches_ = std::move(compacted);
+    allocator_ = allocator;
+  }
+}
+
+// Growing sketches return their old arrays to the arena's free lists,
+// and merges in particular may leave much of the arena idle
+template<typename SK>
+void vector_of_sketches<SK>::compact_if_sparse() {
+  if constexpr (is_arena_allocator<A>::value) {
+    const sketch_arena& arena = *allocator_.get_arena();
+    if (arena.get_reserved_bytes() > 2 * arena.get_allocated_bytes() + sketch_arena::DEFAULT_BLOCK_SIZE) compact_locked();
+  }
+}
+
+template<typename SK>
+size_t vector_of_sketches<SK>::get_allocated_bytes() const {
+  auto lock = read_lock();
+  if constexpr (is_arena_allocator<A>::value) return allocator_.get_arena()->get_allocated_bytes();
+  else throw std::logic_error("memory is only tracked for sketches using an arena");
+}
+
+template<typename SK>
+size_t vector_of_sketches<SK>::get_reserved_bytes() const {
+  auto lock = read_lock();
+  if constexpr (is_arena_allocator<A>::value) return allocator_.get_arena()->get_reserved_bytes();
+  else throw std::logic_error("memory is only tracked for sketches using an arena");
+}
+
+template<typename SK>
+auto vector_of_sketches<SK>::to_default_allocator(SK&& sketch) -> default_sketch {
+  if constexpr (std::is_same<SK, default_sketch>::value) {
+    return std::move(sketch);
+  } else {
+    auto bytes = sketch.serialize();
+    return default_sketch::deserialize(bytes.data(), bytes.size());
   }
 }
 
-template<typename T, typename C>
-kll_sketch<T, C> vector_of_kll_sketches<T, C>::collapse(ArrInputType<int>& isk) const {
+// The result is built with a new allocator, so for arena_allocator
+// it does not take space in the vector's arena
+template<typename SK>
+auto vector_of_sketches<SK>::collapse(ArrInputType<int>& isk) const -> default_sketch {
   Array1D<int> indices = input_to_vec<int>(isk);
+  auto lock = read_lock();
   Array1D<uint32_t> index_arr = get_indices(indices);
   auto inds = index_arr.view();
-  
-  kll_sketch<T, C> result(k_);
+
+  nb::gil_scoped_release release;
+  SK result = traits::make_like(sketches_[0], A());
   for (size_t idx = 0; idx < inds.shape(0); ++idx) {
     result.merge(sketches_[inds(idx)]);
   }
-  return result;
+  return to_default_allocator(std::move(result));
 }
 
 // Number of updates for each sketch
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_n() const -> Array1D<uint64_t> {
+template<typename SK>
+auto vector_of_sketches<SK>::get_n() const -> Array1D<uint64_t> {
+  auto lock = read_lock();
   auto vals = make_ndarray<uint64_t>(d_);
   auto view = vals.view();
   for (uint32_t i = 0; i < d_; ++i) {
-    view(i) = sketches_[i].get_n();
+    view(i) = traits::get_n(sketches_[i]);
   }
   return vals;
 }
 
 // Number of retained values for each sketch
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_num_retained() const -> Array1D<uint32_t> {
+template<typename SK>
+auto vector_of_sketches<SK>::get_num_retained() const -> Array1D<uint32_t> {
+  auto lock = read_lock();
   auto vals = make_ndarray<uint32_t>(d_);
   auto view = vals.view();
   for (uint32_t i = 0; i < d_; ++i) {
@@ -354,25 +756,27 @@ auto vector_of_kll_sketches<T, C>::get_num_retained() const -> Array1D<uint32_t>
 
 // Gets the minimum value of each sketch
 // TODO: allow subsets of sketches
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_min_values() const -> Array1D<T> {
+template<typename SK>
+auto vector_of_sketches<SK>::get_min_values() const -> Array1D<T> {
+  auto lock = read_lock();
   //std::vector<T> vals(d_);
   auto vals = make_ndarray<T>(d_);
   auto view = vals.view();
   for (uint32_t i = 0; i < d_; ++i) {
-    view(i) = sketches_[i].get_min_item();
+    view(i) = traits::get_min_item(sketches_[i]);
   }
   return vals;
 }
 
 // Gets the maximum value of each sketch
 // TODO: allow subsets of sketches
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_max_values() const -> Array1D<T> {
+template<typename SK>
+auto vector_of_sketches<SK>::get_max_values() const -> Array1D<T> {
+  auto lock = read_lock();
   auto vals = make_ndarray<T>(d_);
   auto view = vals.view();
   for (uint32_t i = 0; i < d_; ++i) {
-    view(i) = sketches_[i].get_max_item();
+    view(i) = traits::get_max_item(sketches_[i]);
   }
   return vals;
 }
@@ -380,20 +784,22 @@ auto vector_of_kll_sketches<T, C>::get_max_values() const -> Array1D<T> {
 // Summary of each sketch as one long string
 // Users should use .split('\n\n') when calling it to build a list of each 
 // sketch's summary
-template<typename T, typename C>
-std::string vector_of_kll_sketches<T, C>::to_string(bool print_levels, bool print_items) const {
+template<typename SK>
+std::string vector_of_sketches<SK>::to_string(bool print_levels, bool print_items) const {
+  auto lock = read_lock();
   std::ostringstream ss;
   for (uint32_t i = 0; i < d_; ++i) {
     // all streams into 1 string, for compatibility with Python's str() behavior
     // users will need to split by \n\n, e.g., str(kll).split('\n\n')
     if (i > 0) ss << "\n";
-    ss << sketches_[i].to_string(print_levels, print_items);
+    ss << traits::to_string(sketches_[i], print_levels, print_items);
   }
   return ss.str();
 }
 
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::is_estimation_mode() const -> Array1D<bool> {
+template<typename SK>
+auto vector_of_sketches<SK>::is_estimation_mode() const -> Array1D<bool> {
+  auto lock = read_lock();
   auto vals = make_ndarray<bool>(d_);
   auto view = vals.view();
   for (uint32_t i = 0; i < d_; ++i) {
@@ -402,185 +808,495 @@ auto vector_of_kll_sketches<T, C>::is_estimation_mode() const -> Array1D<bool> {
   return vals;
 }
 
-// Value of sketch(es) corresponding to some quantile(s)
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_quantiles(ArrInputType<double>& ranks,
-                                                 ArrInputType<int>& isk) const -> Array2D<T> {
+template<typename SK>
+template<typename TT>
+std::vector<TT> vector_of_sketches<SK>::input_to_std_vec(ArrInputType<TT>& input) const {
+  Array1D<TT> arr = input_to_vec<TT>(input);
+  auto view = arr.view();
+  std::vector<TT> output(view.shape(0));
+  for (size_t i = 0; i < output.size(); ++i) output[i] = view(i);
+  return output;
+}
+
+// Rows asking for the same sketch are grouped, so that each sketch is
+// visited by a single thread, which matters because building a sorted view
+// may sort the sketch's level zero, and its sorted view is built only once.
+// fill(sorted_view, row) is called without the GIL.
+template<typename SK>
+template<typename TT, typename F>
+auto vector_of_sketches<SK>::query_sketches(ArrInputType<int>& isk, size_t num_cols,
+                                            unsigned num_threads, F&& fill) const -> Array2D<TT> {
   Array1D<int> indices = input_to_vec<int>(isk);
+  auto lock = write_lock();
   Array1D<uint32_t> inds = get_indices(indices);
-  size_t num_sketches = inds.size();
-
-  Array1D<double> ranks_arr = input_to_vec<double>(ranks);
-  size_t num_quantiles = ranks_arr.size();
-
-  auto quants = make_ndarray<T>(num_sketches, num_quantiles);
-  auto view = quants.view();
-  auto ranks_view = ranks_arr.view();
-  for (uint32_t i = 0; i < num_sketches; ++i) {
-    for (size_t j = 0; j < num_quantiles; ++j) {
-      view(i, j) = sketches_[inds(i)].get_quantile(ranks_view(j));
+  const size_t num_rows = inds.size();
+  const uint32_t* sketch_index = inds.data();
+
+  auto result = make_ndarray<TT>(num_rows, num_cols);
+  TT* out = result.data();
+  {
+    nb::gil_scoped_release release;
+    std::vector<size_t> rows(num_rows);
+    std::iota(rows.begin(), rows.end(), 0);
+    std::stable_sort(rows.begin(), rows.end(), [sketch_index](size_t a, size_t b) {
+      return sketch_index[a] < sketch_index[b];
+    });
+    std::vector<size_t> group_starts;
+    for (size_t r = 0; r < num_rows; ++r) {
+      if (r == 0 || sketch_index[rows[r]] != sketch_index[rows[r - 1]]) group_starts.push_back(r);
     }
+    const size_t num_groups = group_starts.size();
+    group_starts.push_back(num_rows);
+
+    num_threads = static_cast<unsigned>(std::min<size_t>(resolve_num_threads(num_threads), num_groups));
+    std::atomic<size_t> next(0);
+    run_in_threads(num_threads, [&](unsigned) {
+      for (size_t g = next++; g < num_groups; g = next++) {
+        const size_t first_row = rows[group_starts[g]];
+        TT* first = out + first_row * num_cols;
+        fill(traits::get_query_view(sketches_[sketch_index[first_row]]), first);
+        for (size_t r = group_starts[g] + 1; r < group_starts[g + 1]; ++r) {
+          std::copy(first, first + num_cols, out + rows[r] * num_cols);
+        }
+      }
+    });
   }
-  return quants;
+  return result;
+}
+
+// Value of sketch(es) corresponding to some quantile(s)
+template<typename SK>
+auto vector_of_sketches<SK>::get_quantiles(ArrInputType<double>& ranks,
+                                           ArrInputType<int>& isk,
+                                           bool inclusive,
+                                           unsigned num_threads) const -> Array2D<T> {
+  const std::vector<double> ranks_vec = input_to_std_vec<double>(ranks);
+  return query_sketches<T>(isk, ranks_vec.size(), num_threads, [&ranks_vec, inclusive](const auto& view, T* row) {
+    for (size_t j = 0; j < ranks_vec.size(); ++j) row[j] = view.get_quantile(ranks_vec[j], inclusive);
+  });
 }
 
 // Value of sketch(es) corresponding to some rank(s)
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_ranks(ArrInputType<T>& values,
-                                             ArrInputType<int>& isk) const -> Array2D<double> {
-  Array1D<int> indices = input_to_vec<int>(isk);
-  Array1D<uint32_t> inds = get_indices(indices);
-  size_t num_sketches = inds.size();
-  
-  Array1D<T> values_arr = input_to_vec<T>(values);
-  size_t num_ranks = values_arr.size();
-  auto vals = values_arr.view();
-
-  auto ranks = make_ndarray<double>(num_sketches, num_ranks);
-  auto view = ranks.view();
-  for (uint32_t i = 0; i < num_sketches; ++i) {
-    const size_t offset = i * num_ranks;
-    for (size_t j = 0; j < num_ranks; ++j) {
-      view(i, j) = sketches_[inds(i)].get_rank(vals(j));
-    }
-  }
-  return ranks;
+template<typename SK>
+auto vector_of_sketches<SK>::get_ranks(ArrInputType<T>& values,
+                                       ArrInputType<int>& isk,
+                                       bool inclusive,
+                                       unsigned num_threads) const -> Array2D<double> {
+  const std::vector<T> values_vec = input_to_std_vec<T>(values);
+  return query_sketches<double>(isk, values_vec.size(), num_threads, [&values_vec, inclusive](const auto& view, double* row) {
+    for (size_t j = 0; j < values_vec.size(); ++j) row[j] = view.get_rank(values_vec[j], inclusive);
+  });
 }
 
 // PMF(s) of sketch(es)
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_pmf(ArrInputType<T>& split_points,
-                                           ArrInputType<int>& isk) const -> Array2D<double> {
-  Array1D<int> indices = input_to_vec<int>(isk);  
-  Array1D<uint32_t> inds = get_indices(indices);
-  size_t num_sketches = inds.size();
-
-  Array1D<T> splits_arr = input_to_vec<T>(split_points);
-  size_t num_splits = splits_arr.size();
-  
-  auto pmfs = make_ndarray<double>(num_sketches, num_splits + 1);
-  auto view = pmfs.view();
-  for (uint32_t i = 0; i < num_sketches; ++i) {
-    auto pmf = sketches_[inds(i)].get_PMF(splits_arr.data(), num_splits);
-    for (size_t j = 0; j <= num_splits; ++j) {
-      view(i, j) = pmf[j];
-    }
-  }
-  return pmfs;
+template<typename SK>
+auto vector_of_sketches<SK>::get_pmf(ArrInputType<T>& split_points,
+                                     ArrInputType<int>& isk,
+                                     bool inclusive,
+                                     unsigned num_threads) const -> Array2D<double> {
+  const std::vector<T> splits = input_to_std_vec<T>(split_points);
+  return query_sketches<double>(isk, splits.size() + 1, num_threads, [&splits, inclusive](const auto& view, double* row) {
+    auto pmf = view.get_PMF(splits.data(), static_cast<uint32_t>(splits.size()), inclusive);
+    std::copy(pmf.begin(), pmf.end(), row);
+  });
 }
 
 // CDF(s) of sketch(es)
-template<typename T, typename C>
-auto vector_of_kll_sketches<T, C>::get_cdf(ArrInputType<T>& split_points,
-                                           ArrInputType<int>& isk) const -> Array2D<double> {
-  Array1D<int> indices = input_to_vec<int>(isk);
-  Array1D<uint32_t> inds = get_indices(indices);
-  size_t num_sketches = inds.size();
-
-  Array1D<T> splits_arr = input_to_vec<T>(split_points);
-  size_t num_splits = splits_arr.size();
-
-  auto cdfs = make_ndarray<double>(num_sketches, num_splits + 1);
-  auto view = cdfs.view();
-  for (uint32_t i = 0; i < num_sketches; ++i) {
-    auto cdf = sketches_[inds(i)].get_CDF(splits_arr.data(), num_splits);
-    for (size_t j = 0; j <= num_splits; ++j) {
-      view(i, j) = cdf[j];
-    }
-  }
-  return cdfs;
+template<typename SK>
+auto vector_of_sketches<SK>::get_cdf(ArrInputType<T>& split_points,
+                                     ArrInputType<int>& isk,
+                                     bool inclusive,
+                                     unsigned num_threads) const -> Array2D<double> {
+  const std::vector<T> splits = input_to_std_vec<T>(split_points);
+  return query_sketches<double>(isk, splits.size() + 1, num_threads, [&splits, inclusive](const auto& view, double* row) {
+    auto cdf = view.get_CDF(splits.data(), static_cast<uint32_t>(splits.size()), inclusive);
+    std::copy(cdf.begin(), cdf.end(), row);
+  });
 }
 
-template<typename T, typename C>
-void vector_of_kll_sketches<T, C>::deserialize(const nb::bytes& sk_bytes,
-                                               uint32_t idx) {
+template<typename SK>
+void vector_of_sketches<SK>::deserialize(nb::handle sk_bytes,
+                                         uint32_t idx,
+                                         size_t offset,
+                                         const std::optional<size_t>& length) {
+  py_buffer buffer(sk_bytes, offset, length);
+  auto lock = write_lock();
   if (idx >= d_) {
     throw std::invalid_argument("request for invalid dimensions >= d ("
              + std::to_string(d_) +"): "+ std::to_string(idx));
   }
   // load the sketch into the proper index
-  sketches_[idx] = std::move(kll_sketch<T>::deserialize(sk_bytes.c_str(), sk_bytes.size()));
+  nb::gil_scoped_release release;
+  sketches_[idx] = traits::deserialize(buffer.data(), buffer.size(), allocator_);
 }
 
-template<typename T, typename C>
-nb::list vector_of_kll_sketches<T, C>::serialize(ArrInputType<int>& isk) {
+template<typename SK>
+nb::list vector_of_sketches<SK>::serialize(ArrInputType<int>& isk) {
   Array1D<int> indices = input_to_vec<int>(isk);
+  auto lock = write_lock();
   Array1D<uint32_t> inds = get_indices(indices);
   const size_t num_sketches = inds.size();
 
   nb::list list;
   for (uint32_t i = 0; i < num_sketches; ++i) {
-    auto serResult = sketches_[inds(i)].serialize();
-    list.append(nb::bytes((char*)serResult.data(), serResult.size()));
+    const SK& sk = sketches_[inds(i)];
+    list.append(serialize_to_bytes(sk.get_serialized_size_bytes(), [&sk](std::ostream& os) { sk.serialize(os); }));
   }
 
   return list;
 }
 
+// Bulk serialization layout, in native (little-endian) byte order:
+//   bytes 0-3    magic number
+//   byte  4      serial version
+//   byte  5      size of an item in bytes
+//   byte  6      sketch family id
+//   byte  7      unused
+//   bytes 8-11   k
+//   bytes 12-15  d
+//   then d + 1 offsets of 8 bytes each, relative to the end of this table,
+//   where sketch i occupies [offset i, offset i + 1)
+//   then the sketches in their usual serialized form, concatenated
+template<typename SK>
+nb::bytes vector_of_sketches<SK>::serialize_all() const {
+  using namespace vector_of_kll_constants;
+  auto lock = write_lock();
+  std::vector<uint64_t> offsets(d_ + 1, 0);
+  for (uint32_t i = 0; i < d_; ++i) {
+    offsets[i + 1] = offsets[i] + sketches_[i].get_serialized_size_bytes();
+  }
+  const size_t size = BLOB_HEADER_BYTES + sizeof(uint64_t) * offsets.size() + offsets[d_];
+  return serialize_to_bytes(size, [this, &offsets](std::ostream& os) {
+    nb::gil_scoped_release release;
+    write(os, BLOB_MAGIC);
+    write(os, BLOB_SERIAL_VERSION);
+    write(os, static_cast<uint8_t>(sizeof(T)));
+    write(os, traits::FAMILY_ID);
+    write(os, static_cast<uint8_t>(0));
+    write(os, k_);
+    write(os, d_);
+    os.write(reinterpret_cast<const char*>(offsets.data()), sizeof(uint64_t) * offsets.size());
+    for (const auto& sk: sketches_) sk.serialize(os);
+  });
+}
+
+template<typename SK>
+auto vector_of_sketches<SK>::read_blob_index(const char* data, size_t size) -> blob_index {
+  using namespace vector_of_kll_constants;
+  check_memory_size(BLOB_HEADER_BYTES, size);
+  uint32_t magic;
+  uint8_t serial_version;
+  uint8_t item_size;
+  uint8_t family_id;
+  blob_index index;
+  std::memcpy(&magic, data, sizeof(magic));
+  std::memcpy(&serial_version, data + 4, sizeof(serial_version));
+  std::memcpy(&item_size, data + 5, sizeof(item_size));
+  std::memcpy(&family_id, data + 6, sizeof(family_id));
+  std::memcpy(&index.k, data + 8, sizeof(index.k));
+  std::memcpy(&index.d, data + 12, sizeof(index.d));
+  if (magic != BLOB_MAGIC) {
+    throw std::invalid_argument("input is not a serialized vector of sketches");
+  }
+  if (family_id != traits::FAMILY_ID) {
+    throw std::invalid_argument("serialized sketches are of family " + std::to_string(family_id)
+      + ", but this type expects " + std::to_string(traits::FAMILY_ID));
+  }
+  if (serial_version != BLOB_SERIAL_VERSION) {
+    throw std::invalid_argument("unsupported serial version: " + std::to_string(serial_version));
+  }
+  if (item_size != sizeof(T)) {
+    throw std::invalid_argument("serialized items are " + std::to_string(item_size)
+      + " bytes each, but this type expects " + std::to_string(sizeof(T)));
+  }
+  if (index.d < 1) {
+    throw std::invalid_argument("D must be >= 1: " + std::to_string(index.d));
+  }
+  const size_t table_end = BLOB_HEADER_BYTES + sizeof(uint64_t) * (static_cast<size_t>(index.d) + 1);
+  check_memory_size(table_end, size);
+  index.offsets = data + BLOB_HEADER_BYTES;
+  index.sketches = data + table_end;
+  index.sketches_size = size - table_end;
+  return index;
+}
+
+template<typename SK>
+std::pair<const char*, size_t> vector_of_sketches<SK>::get_blob_sketch(const blob_index& index, uint32_t idx) {
+  uint64_t begin;
+  uint64_t end;
+  std::memcpy(&begin, index.offsets + sizeof(uint64_t) * idx, sizeof(begin));
+  std::memcpy(&end, index.offsets + sizeof(uint64_t) * (idx + 1), sizeof(end));
+  if (begin > end) {
+    throw std::invalid_argument("corrupt offset table at dimension " + std::to_string(idx));
+  }
+  check_memory_size(end, index.sketches_size);
+  return std::make_pair(index.sketches + begin, static_cast<size_t>(end - begin));
+}
+
+template<typename SK>
+vector_of_sketches<SK> vector_of_sketches<SK>::deserialize_all(nb::handle bytes,
+                                                               size_t offset,
+                                                               const std::optional<size_t>& length,
+                                                               unsigned num_threads) {
+  py_buffer buffer(bytes, offset, length);
+  nb::gil_scoped_release release;
+  const blob_index index = read_blob_index(static_cast<const char*>(buffer.data()), buffer.size());
+  const A allocator;
+  std::vector<std::optional<SK>> loaded(index.d);
+  num_threads = std::min(resolve_num_threads(num_threads), index.d);
+  std::atomic<uint32_t> next(0);
+  run_in_threads(num_threads, [&](unsigned) {
+    for (uint32_t i = next++; i < index.d; i = next++) {
+      const auto sketch_bytes = get_blob_sketch(index, i);
+      loaded[i].emplace(traits::deserialize(sketch_bytes.first, sketch_bytes.second, allocator));
+    }
+  });
+  std::vector<SK> sketches;
+  sketches.reserve(index.d);
+  for (auto& sk: loaded) sketches.push_back(std::move(*sk));
+  return vector_of_sketches<SK>(index.k, std::move(sketches), allocator);
+}
+
+template<typename SK>
+auto vector_of_sketches<SK>::deserialize_sketch(nb::handle bytes,
+                                                uint32_t idx,
+                                                size_t offset,
+                                                const std::optional<size_t>& length) -> default_sketch {
+  py_buffer buffer(bytes, offset, length);
+  nb::gil_scoped_release release;
+  const blob_index index = read_blob_index(static_cast<const char*>(buffer.data()), buffer.size());
+  if (idx >= index.d) {
+    throw std::invalid_argument("request for invalid dimensions >= d ("
+             + std::to_string(index.d) +"): "+ std::to_string(idx));
+  }
+  const auto sketch_bytes = get_blob_sketch(index, idx);
+  return default_sketch::deserialize(sketch_bytes.first, sketch_bytes.second);
+}
+
+template<typename T, typename C = std::less<T>, typename A = std::allocator<T>>
+using vector_of_kll_sketches = vector_of_sketches<kll_sketch<T, C, A>>;
+
 } // namespace datasketches
 
-template<typename T>
-void bind_vector_of_kll_sketches(nb::module_ &m, const char* name) {
-  using namespace datasketches;
+// Methods shared by vectors of every sketch family
+template<typename SK>
+void bind_vector_of_sketches(nb::class_<datasketches::vector_of_sketches<SK>>& vector_class) {
+  using VK = datasketches::vector_of_sketches<SK>;
 
-  nb::class_<vector_of_kll_sketches<T>>(m, name)
-    .def(nb::init<uint32_t, uint32_t>(), nb::arg("k")=vector_of_kll_constants::DEFAULT_K, 
-                                         nb::arg("d")=vector_of_kll_constants::DEFAULT_D,
-         "Creates a new Vector of KLL Sketches instance with the given values of k and d.\n\n"
-         ":param k: The value of k for every sketch in the vector\n:type k: int\n"
-         ":param d: The number of sketches in the vector\n:type d: int"
-        )
-    .def("__copy__", [](const vector_of_kll_sketches<T>& sk){ return vector_of_kll_sketches<T>(sk); })
+  vector_class
+    .def("__copy__", [](const VK& sk){ return VK(sk); })
     // allow user to retrieve k or d, in case it's instantiated w/ defaults
-    .def_prop_ro("k", &vector_of_kll_sketches<T>::get_k,
+    .def_prop_ro("k", &VK::get_k,
          "The value of `k` of the sketch(es)")
-    .def_prop_ro("d", &vector_of_kll_sketches<T>::get_d,
+    .def_prop_ro("d", &VK::get_d,
          "The number of sketches")
-    .def("update", &vector_of_kll_sketches<T>::update, nb::arg("items"), nb::arg("order") = "C",
+    .def("update", &VK::update, nb::arg("items"), nb::arg("order") = "C",
+         nb::arg("num_threads") = 1,
          "Updates the sketch(es) with value(s).  Must be a 1D array of size equal to the number of sketches.  Can also be 2D array of shape (n_updates, n_sketches).  If a sketch does not have a value to update, use np.nan. "
-         " Order 'F' specifies a column-major (Fortran style) matrix; any other value assumes row-major (C style) matrix.")
-    .def("__str__", [](const vector_of_kll_sketches<T>& sk) { return sk.to_string(); },
+         " Any memory layout is accepted; `order` is retained for compatibility and no longer needs to match the array. "
+         " With `num_threads` > 1 the sketches are updated in parallel, in groups of dimensions; 0 uses one thread per core.")
+    .def("update_grouped", &VK::update_grouped, nb::arg("group_ids"), nb::arg("items"),
+         "Updates the sketch at index `group_ids[i]` with `items[i]` for each i, in one pass.  Both must be 1D arrays of equal length, "
+         "and every id must be in [0, d).  NaN items are skipped.")
+    .def("add_dimensions", &VK::add_dimensions, nb::arg("n"),
+         "Appends `n` empty sketches to the vector, returning the new number of sketches `d`.")
+    .def("__str__", [](const VK& sk) { return sk.to_string(); },
          "Produces a string summary of all sketches. Users should split the returned string by '\\n\\n'")
-    .def("to_string", &vector_of_kll_sketches<T>::to_string, nb::arg("print_levels")=false,
-                                                             nb::arg("print_items")=false,
+    .def("to_string", &VK::to_string, nb::arg("print_levels")=false,
+                                      nb::arg("print_items")=false,
          "Produces a string summary of all sketches. Users should split the returned string by '\\n\\n'")
-    .def("is_empty", &vector_of_kll_sketches<T>::is_empty,
+    .def("is_empty", &VK::is_empty,
          "Returns whether the sketch(es) is(are) empty of not")
-    .def("get_n", &vector_of_kll_sketches<T>::get_n, 
+    .def("get_n", &VK::get_n, 
          "Returns the number of values seen by the sketch(es)")
-    .def("get_num_retained", &vector_of_kll_sketches<T>::get_num_retained, 
-         "Returns the number of values retained by the sketch(es)")
-    .def("is_estimation_mode", &vector_of_kll_sketches<T>::is_estimation_mode, 
-         "Returns whether the sketch(es) is(are) in estimation mode")
-    .def("get_min_values", &vector_of_kll_sketches<T>::get_min_values,
+    .def("get_min_values", &VK::get_min_values,
          "Returns the minimum value(s) of the sketch(es)")
-    .def("get_max_values", &vector_of_kll_sketches<T>::get_max_values,
+    .def("get_max_values", &VK::get_max_values,
          "Returns the maximum value(s) of the sketch(es)")
-    .def("get_quantiles", &vector_of_kll_sketches<T>::get_quantiles, nb::arg("ranks"),
-                                                                     nb::arg("isk")=-1, 
-         "Returns the value(s) associated with the specified quantile(s) for the specified sketch(es). `ranks` can be a float between 0 and 1 (inclusive), or a list/array of values. `isk` specifies which sketch(es) to return the value(s) for (default: all sketches)")
-    .def("get_ranks", &vector_of_kll_sketches<T>::get_ranks,
-         nb::arg("value"), nb::arg("isk")=-1, 
-         "Returns the value(s) associated with the specified rank(s) for the specified sketch(es). `values` can be an int between 0 and the number of values retained, or a list/array of values. `isk` specifies which sketch(es) to return the value(s) for (default: all sketches)")
-    .def("get_pmf", &vector_of_kll_sketches<T>::get_pmf, nb::arg("split_points"), nb::arg("isk")=-1, 
-         "Returns the probability mass function (PMF) at `split_points` of the specified sketch(es).  `split_points` should be a list/array of floats between 0 and 1 (inclusive). `isk` specifies which sketch(es) to return the PMF for (default: all sketches)")
-    .def("get_cdf", &vector_of_kll_sketches<T>::get_cdf, nb::arg("split_points"), nb::arg("isk")=-1, 
-         "Returns the cumulative distribution function (CDF) at `split_points` of the specified sketch(es).  `split_points` should be a list/array of floats between 0 and 1 (inclusive). `isk` specifies which sketch(es) to return the CDF for (default: all sketches)")
+    .def("get_quantiles", &VK::get_quantiles, nb::arg("ranks"),
+                                              nb::arg("isk")=-1,
+                                              nb::arg("inclusive")=true,
+                                              nb::arg("num_threads")=1,
+         "Returns the value(s) associated with the specified quantile(s) for the specified sketch(es). `ranks` can be a float between 0 and 1 (inclusive), or a list/array of values. `isk` specifies which sketch(es) to return the value(s) for (default: all sketches). "
+         "`inclusive` selects the inclusive or exclusive definition of rank (default: True), and is ignored by t-digest. With `num_threads` > 1 the sketches are queried in parallel; 0 uses one thread per core.")
+    .def("get_ranks", &VK::get_ranks,
+         nb::arg("value"), nb::arg("isk")=-1, nb::arg("inclusive")=true, nb::arg("num_threads")=1,
+         "Returns the value(s) associated with the specified rank(s) for the specified sketch(es). `values` can be an int between 0 and the number of values retained, or a list/array of values. `isk` specifies which sketch(es) to return the value(s) for (default: all sketches). "
+         "`inclusive` selects the inclusive or exclusive definition of rank (default: True), and is ignored by t-digest. With `num_threads` > 1 the sketches are queried in parallel; 0 uses one thread per core.")
+    .def("get_pmf", &VK::get_pmf, nb::arg("split_points"), nb::arg("isk")=-1,
+         nb::arg("inclusive")=true, nb::arg("num_threads")=1,
+         "Returns the probability mass function (PMF) at `split_points` of the specified sketch(es).  `split_points` should be a list/array of floats between 0 and 1 (inclusive). `isk` specifies which sketch(es) to return the PMF for (default: all sketches). "
+         "`inclusive` selects the inclusive or exclusive definition of rank (default: True), and is ignored by t-digest. With `num_threads` > 1 the sketches are queried in parallel; 0 uses one thread per core.")
+    .def("get_cdf", &VK::get_cdf, nb::arg("split_points"), nb::arg("isk")=-1,
+         nb::arg("inclusive")=true, nb::arg("num_threads")=1,
+         "Returns the cumulative distribution function (CDF) at `split_points` of the specified sketch(es).  `split_points` should be a list/array of floats between 0 and 1 (inclusive). `isk` specifies which sketch(es) to return the CDF for (default: all sketches). "
+         "`inclusive` selects the inclusive or exclusive definition of rank (default: True), and is ignored by t-digest. With `num_threads` > 1 the sketches are queried in parallel; 0 uses one thread per core.")
+    .def("serialize", &VK::serialize, nb::arg("isk")=-1, 
+         "Serializes the specified sketch(es). `isk` can be an int or a list/array of ints (default: all sketches)")
+    .def("deserialize", &VK::deserialize, nb::arg("skBytes"), nb::arg("isk"),
+                                          nb::arg("offset")=0, nb::arg("length")=nb::none(),
+         "Deserializes the specified sketch from a bytes-like object, optionally a slice of it given by `offset` and `length`.  `isk` must be an int.")
+    .def("serialize_all", &VK::serialize_all,
+         "Serializes all sketches into a single bytes object, with a header holding k, d and the offset of each sketch")
+    .def_static("deserialize_all", &VK::deserialize_all, nb::arg("bytes"),
+                nb::arg("offset")=0, nb::arg("length")=nb::none(), nb::arg("num_threads")=1,
+         "Reconstructs a vector of sketches from the output of serialize_all(), held in any bytes-like object such as a memory-mapped file, "
+         "optionally a slice of it given by `offset` and `length`.  With `num_threads` > 1 the sketches are deserialized in parallel; 0 uses one thread per core.")
+    .def_static("deserialize_sketch", &VK::deserialize_sketch, nb::arg("bytes"), nb::arg("isk"),
+                nb::arg("offset")=0, nb::arg("length")=nb::none(),
+         "Returns the single sketch at index `isk` of the output of serialize_all(), reading only its header, offset table and that sketch.")
+    .def("merge", &VK::merge, nb::arg("array_of_sketches"),
+         "Merges the input array of sketches into the existing array.")
+    .def("collapse", &VK::collapse, nb::arg("isk")=-1,
+         "Returns the result of collapsing all sketches in the array into a single sketch.  'isk' can be an int or a list/array of ints (default: all sketches)")
+    ;
+}
+
+// Methods of the families with a bounded rank error
+template<typename SK>
+void bind_vector_estimation_mode(nb::class_<datasketches::vector_of_sketches<SK>>& vector_class) {
+  using VK = datasketches::vector_of_sketches<SK>;
+
+  vector_class
+    .def("get_num_retained", &VK::get_num_retained, 
+         "Returns the number of values retained by the sketch(es)")
+    .def("is_estimation_mode", &VK::is_estimation_mode, 
+         "Returns whether the sketch(es) is(are) in estimation mode")
+    ;
+}
+
+// Kolmogorov-Smirnov tests between matching sketches of two vectors
+template<typename SK>
+void bind_vector_ks_test(nb::module_ &m) {
+  using namespace datasketches;
+  using VK = vector_of_sketches<SK>;
+
+  m.def("ks_test_many",
+      [](const VK& sketches_1, const VK& sketches_2, double p, unsigned num_threads) {
+        return sketches_1.ks_test(sketches_2, p, num_threads);
+      },
+      nb::arg("sketches_1"), nb::arg("sketches_2"), nb::arg("p"), nb::arg("num_threads")=1,
+      "Performs the Kolmogorov-Smirnov Test between each pair of matching sketches of two vectors of KLL "
+      "or classic quantiles sketches of the same type and number of sketches.\n"
+      "Returns a tuple of two arrays: whether the null hypothesis (that both sketches reflect the same underlying "
+      "distribution) can be rejected using the provided p-value, and the test statistic of each pair. "
+      "Pairs with an empty sketch are not rejected. "
+      "With `num_threads` > 1 the pairs are tested in parallel; 0 uses one thread per core.");
+}
+
+template<typename T, typename A = std::allocator<T>>
+void bind_vector_of_kll_sketches(nb::module_ &m, const char* name) {
+  using namespace datasketches;
+  using VK = vector_of_kll_sketches<T, std::less<T>, A>;
+
+  auto vector_class = nb::class_<VK>(m, name);
+  vector_class
+    .def("__init__", [](VK* self, uint16_t k, uint32_t d) { new (self) VK(d, k); },
+         nb::arg("k")=vector_of_kll_constants::DEFAULT_K, nb::arg("d")=vector_of_kll_constants::DEFAULT_D,
+         "Creates a new Vector of KLL Sketches instance with the given values of k and d.\n\n"
+         ":param k: The value of k for every sketch in the vector\n:type k: int\n"
+         ":param d: The number of sketches in the vector\n:type d: int"
+        )
     .def_static("get_normalized_rank_error",
         [](uint16_t k, bool pmf) { return kll_sketch<T>::get_normalized_rank_error(k, pmf); },
          nb::arg("k"), nb::arg("as_pmf"), "Returns the normalized rank error")
-    .def("serialize", &vector_of_kll_sketches<T>::serialize, nb::arg("isk")=-1, 
-         "Serializes the specified sketch(es). `isk` can be an int or a list/array of ints (default: all sketches)")
-    .def("deserialize", &vector_of_kll_sketches<T>::deserialize, nb::arg("skBytes"), nb::arg("isk"), 
-         "Deserializes the specified sketch.  `isk` must be an int.")
-    .def("merge", &vector_of_kll_sketches<T>::merge, nb::arg("array_of_sketches"),
-         "Merges the input array of KLL sketches into the existing array.")
-    .def("collapse", &vector_of_kll_sketches<T>::collapse, nb::arg("isk")=-1,
-         "Returns the result of collapsing all sketches in the array into a single sketch.  'isk' can be an int or a list/array of ints (default: all sketches)")
     ;
+  bind_vector_of_sketches(vector_class);
+  bind_vector_estimation_mode(vector_class);
+
+  if constexpr (is_arena_allocator<A>::value) {
+    vector_class
+      .def("compact", &VK::compact,
+           "Copies all sketches into a new arena, releasing the space left unused by earlier updates and merges.  This also happens automatically after a merge leaves most of the arena unused.")
+      .def_prop_ro("allocated_bytes", &VK::get_allocated_bytes,
+           "The number of bytes of the arena currently used by the sketches")
+      .def_prop_ro("reserved_bytes", &VK::get_reserved_bytes,
+           "The number of bytes held by the arena, including free space")
+      ;
+  }
+}
+
+template<typename T>
+void bind_vector_of_quantiles_sketches(nb::module_ &m, const char* name) {
+  using namespace datasketches;
+  using VK = vector_of_sketches<quantiles_sketch<T>>;
+
+  auto vector_class = nb::class_<VK>(m, name);
+  vector_class
+    .def("__init__", [](VK* self, uint16_t k, uint32_t d) { new (self) VK(d, k); },
+         nb::arg("k")=quantiles_constants::DEFAULT_K, nb::arg("d")=vector_of_kll_constants::DEFAULT_D,
+         "Creates a new Vector of classic quantiles sketches with the given values of k and d.\n\n"
+         ":param k: The value of k for every sketch in the vector. Default is 128.\n:type k: int\n"
+         ":param d: The number of sketches in the vector\n:type d: int"
+        )
+    .def_static("get_normalized_rank_error",
+        [](uint16_t k, bool pmf) { return quantiles_sketch<T>::get_normalized_rank_error(k, pmf); },
+         nb::arg("k"), nb::arg("as_pmf"), "Returns the normalized rank error")
+    ;
+  bind_vector_of_sketches(vector_class);
+  bind_vector_estimation_mode(vector_class);
+}
+
+template<typename T>
+void bind_vector_of_req_sketches(nb::module_ &m, const char* name) {
+  using namespace datasketches;
+  using VK = vector_of_sketches<req_sketch<T>>;
+
+  auto vector_class = nb::class_<VK>(m, name);
+  vector_class
+    .def("__init__", [](VK* self, uint16_t k, uint32_t d, bool is_hra) { new (self) VK(d, k, is_hra); },
+         nb::arg("k")=12, nb::arg("d")=vector_of_kll_constants::DEFAULT_D, nb::arg("is_hra")=true,
+         "Creates a new Vector of REQ sketches with the given values of k and d.\n\n"
+         ":param k: The value of k for every sketch in the vector. Default is 12.\n:type k: int\n"
+         ":param d: The number of sketches in the vector\n:type d: int\n"
+         ":param is_hra: If True, the sketches favor accuracy at high ranks, otherwise at low ranks. Default True\n:type is_hra: bool"
+        )
+    ;
+  bind_vector_of_sketches(vector_class);
+  bind_vector_estimation_mode(vector_class);
+}
+
+template<typename T>
+void bind_vector_of_tdigests(nb::module_ &m, const char* name) {
+  using namespace datasketches;
+  using VK = vector_of_sketches<tdigest<T>>;
+
+  auto vector_class = nb::class_<VK>(m, name);
+  vector_class
+    .def("__init__", [](VK* self, uint16_t k, uint32_t d) { new (self) VK(d, k); },
+         nb::arg("k")=tdigest<T>::DEFAULT_K, nb::arg("d")=vector_of_kll_constants::DEFAULT_D,
+         "Creates a new Vector of t-digests with the given values of k and d.\n\n"
+         ":param k: The value of k for every t-digest in the vector. Default is 200.\n:type k: int\n"
+         ":param d: The number of t-digests in the vector\n:type d: int"
+        )
+    ;
+  bind_vector_of_sketches(vector_class);
 }
 
 void init_vector_of_kll(nb::module_ &m) {
   bind_vector_of_kll_sketches<int>(m, "vector_of_kll_ints_sketches");
   bind_vector_of_kll_sketches<float>(m, "vector_of_kll_floats_sketches");
+  bind_vector_of_kll_sketches<double>(m, "vector_of_kll_doubles_sketches");
+  bind_vector_of_kll_sketches<int64_t>(m, "vector_of_kll_longs_sketches");
+
+  // all sketches share one arena, for large numbers of small sketches
+  bind_vector_of_kll_sketches<int, datasketches::arena_allocator<int>>(m, "vector_of_kll_ints_arena_sketches");
+  bind_vector_of_kll_sketches<float, datasketches::arena_allocator<float>>(m, "vector_of_kll_floats_arena_sketches");
+  bind_vector_of_kll_sketches<double, datasketches::arena_allocator<double>>(m, "vector_of_kll_doubles_arena_sketches");
+  bind_vector_of_kll_sketches<int64_t, datasketches::arena_allocator<int64_t>>(m, "vector_of_kll_longs_arena_sketches");
+
+  // the same container over the other quantile sketch families
+  bind_vector_of_quantiles_sketches<float>(m, "vector_of_quantiles_floats_sketches");
+  bind_vector_of_quantiles_sketches<double>(m, "vector_of_quantiles_doubles_sketches");
+  bind_vector_of_req_sketches<float>(m, "vector_of_req_floats_sketches");
+  bind_vector_of_req_sketches<double>(m, "vector_of_req_doubles_sketches");
+  bind_vector_of_tdigests<float>(m, "vector_of_tdigest_floats");
+  bind_vector_of_tdigests<double>(m, "vector_of_tdigest_doubles");
+
+  bind_vector_ks_test<datasketches::kll_sketch<int>>(m);
+  bind_vector_ks_test<datasketches::kll_sketch<float>>(m);
+  bind_vector_ks_test<datasketches::kll_sketch<double>>(m);
+  bind_vector_ks_test<datasketches::kll_sketch<int64_t>>(m);
+  bind_vector_ks_test<datasketches::quantiles_sketch<float>>(m);
+  bind_vector_ks_test<datasketches::quantiles_sketch<double>>(m);
 }
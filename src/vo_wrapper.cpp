@@ -22,6 +22,8 @@
 #include <nanobind/stl/function.h>
 #include <nanobind/stl/string.h>
 
+#include "py_buffer.hpp"
+#include "py_output_buffer.hpp"
 #include "py_serde.hpp"
 #include "py_object_ostream.hpp"
 
@@ -79,15 +81,29 @@ void bind_vo_sketch(nb::module_ &m, const char* name) {
          "Computes the size in bytes needed to serialize the current sketch")
     .def("serialize",
          [](const var_opt_sketch<T>& sk, py_object_serde& serde) {
-           auto bytes = sk.serialize(0, serde);
-           return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+           return serialize_to_bytes(sk.get_serialized_size_bytes(serde), [&sk, &serde](std::ostream& os) {
+             sk.serialize(os, serde);
+           });
          }, nb::arg("serde"),
          "Serializes the sketch into a bytes object")
+    .def("serialize_into",
+         [](const var_opt_sketch<T>& sk, nb::handle buffer, py_object_serde& serde, size_t offset) {
+           return serialize_into(buffer, offset, sk.get_serialized_size_bytes(serde), [&sk, &serde](std::ostream& os) {
+             sk.serialize(os, serde);
+           });
+         },
+         nb::arg("buffer"), nb::arg("serde"), nb::arg("offset")=0,
+         "Serializes the sketch into a writable buffer, such as a bytearray or memoryview, starting at the given offset "
+         "and using the provided serde. Returns the number of bytes written.")
     .def_static(
          "deserialize",
-         [](const nb::bytes& bytes, py_object_serde& serde) { return var_opt_sketch<T>::deserialize(bytes.c_str(), bytes.size(), serde); },
-         nb::arg("bytes"), nb::arg("serde"),
-         "Reads a bytes object and returns the corresponding var opt sketch")
+         [](nb::handle bytes, py_object_serde& serde, size_t offset, std::optional<size_t> length) {
+           py_buffer buffer(bytes, offset, length);
+           return var_opt_sketch<T>::deserialize(buffer.data(), buffer.size(), serde);
+         },
+         nb::arg("bytes"), nb::arg("serde"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+         "Reads a bytes-like object, optionally a slice of it given by offset and length, "
+         "and returns the corresponding var opt sketch")
     .def("__iter__",
           [](const var_opt_sketch<T>& sk) {
                return nb::make_iterator(nb::type<var_opt_sketch<T>>(),
@@ -121,15 +137,29 @@ void bind_vo_union(nb::module_ &m, const char* name) {
          "Computes the size in bytes needed to serialize the current union")
     .def("serialize",
          [](const var_opt_union<T>& u, py_object_serde& serde) {
-           auto bytes = u.serialize(0, serde);
-           return nb::bytes(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+           return serialize_to_bytes(u.get_serialized_size_bytes(serde), [&u, &serde](std::ostream& os) {
+             u.serialize(os, serde);
+           });
          }, nb::arg("serde"),
          "Serializes the union into a bytes object with the provided serde")
+    .def("serialize_into",
+         [](const var_opt_union<T>& u, nb::handle buffer, py_object_serde& serde, size_t offset) {
+           return serialize_into(buffer, offset, u.get_serialized_size_bytes(serde), [&u, &serde](std::ostream& os) {
+             u.serialize(os, serde);
+           });
+         },
+         nb::arg("buffer"), nb::arg("serde"), nb::arg("offset")=0,
+         "Serializes the union into a writable buffer, such as a bytearray or memoryview, starting at the given offset "
+         "and using the provided serde. Returns the number of bytes written.")
     .def_static(
          "deserialize",
-         [](const nb::bytes& bytes, py_object_serde& serde) { return var_opt_union<T>::deserialize(bytes.c_str(), bytes.size(), serde); },
-         nb::arg("bytes"), nb::arg("serde"),
-         "Constructs a var opt union from the given bytes using the provided serde")
+         [](nb::handle bytes, py_object_serde& serde, size_t offset, std::optional<size_t> length) {
+           py_buffer buffer(bytes, offset, length);
+           return var_opt_union<T>::deserialize(buffer.data(), buffer.size(), serde);
+         },
+         nb::arg("bytes"), nb::arg("serde"), nb::arg("offset")=0, nb::arg("length")=nb::none(),
+         "Constructs a var opt union from the given bytes-like object, optionally a slice of it "
+         "given by offset and length, using the provided serde")
     ;
 }
 
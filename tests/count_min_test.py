@@ -16,6 +16,7 @@
 # under the License.
   
 import unittest
+import numpy as np
 from datasketches import count_min_sketch
 
 class CountMinTest(unittest.TestCase):
@@ -86,5 +87,16 @@ class CountMinTest(unittest.TestCase):
     self.assertGreater(len(cm.to_string()), 0)
     self.assertEqual(len(cm.__str__()), len(cm.to_string()))
 
+  def test_count_min_string_array_update(self):
+    cm = count_min_sketch(3, 128)
+    cm_loop = count_min_sketch(3, 128)
+    words = np.array(['apple', 'banana', 'cherry', 'apple'])
+    cm.update_strings(words, 2.0)
+    for w in words:
+      cm_loop.update(str(w), 2.0)
+    self.assertEqual(cm.total_weight, cm_loop.total_weight)
+    for w in ['apple', 'banana', 'cherry', 'durian']:
+      self.assertEqual(cm.get_estimate(w), cm_loop.get_estimate(w))
+
 if __name__ == '__main__':
     unittest.main()
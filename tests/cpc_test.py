@@ -16,6 +16,7 @@
 # under the License.
 
 import unittest
+import numpy as np
 from datasketches import cpc_sketch, cpc_union
 
 class CpcTest(unittest.TestCase):
@@ -69,5 +70,57 @@ class CpcTest(unittest.TestCase):
     cpc = cpc_sketch(lgk)
     self.assertEqual(cpc.lg_k, lgk)
 
+  def test_cpc_array_update(self):
+    lgk = 10
+    n = 1 << 12
+    ints = np.arange(n, dtype=np.uint64)
+    doubles = np.linspace(0.0, 1.0, n)
+
+    # array updates hash each element exactly as the scalar update does
+    cpc = cpc_sketch(lgk)
+    cpc.update(ints)
+    cpc.update(doubles[::2])
+    cpc_loop = cpc_sketch(lgk)
+    for i in range(0, n):
+      cpc_loop.update(i)
+    for d in doubles[::2]:
+      cpc_loop.update(float(d))
+    self.assertEqual(cpc.get_estimate(), cpc_loop.get_estimate())
+
+  def test_cpc_serialize_into(self):
+    cpc = cpc_sketch(10)
+    cpc.update(np.arange(1 << 12, dtype=np.int64))
+    sk_bytes = cpc.serialize()
+    self.assertEqual(cpc.get_serialized_size_bytes(), len(sk_bytes))
+
+    buf = bytearray(4 + len(sk_bytes))
+    self.assertEqual(cpc.serialize_into(buf, 4), len(sk_bytes))
+    self.assertEqual(bytes(buf[4:]), sk_bytes)
+
+    # a buffer that is too small is left untouched
+    with self.assertRaises(ValueError):
+      cpc.serialize_into(buf, 5)
+    self.assertEqual(bytes(buf[4:]), sk_bytes)
+
+  def test_cpc_union_update_serialized(self):
+    lgk = 11
+    n = 3000
+    sketches = []
+    for i in range(12):
+      cpc = cpc_sketch(lgk)
+      cpc.update(np.arange(i * n // 2, i * n // 2 + n, dtype=np.int64))
+      sketches.append(cpc)
+    blobs = [sk.serialize() for sk in sketches]
+
+    union = cpc_union(lgk)
+    for sk in sketches:
+      union.update(sk)
+
+    # the union only depends on the set of coupons, not on how the inputs are split
+    for num_threads in [1, 3, 0]:
+      bulk_union = cpc_union(lgk)
+      bulk_union.update_serialized(blobs, num_threads)
+      self.assertEqual(bulk_union.get_result().get_estimate(), union.get_result().get_estimate())
+
 if __name__ == '__main__':
     unittest.main()
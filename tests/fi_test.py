@@ -16,6 +16,7 @@
 # under the License.
  
 import unittest
+import numpy as np
 from datasketches import frequent_strings_sketch, frequent_items_sketch
 from datasketches import frequent_items_error_type, PyIntsSerDe
 
@@ -148,5 +149,46 @@ class FiTest(unittest.TestCase):
     reference_apriori_error = frequent_strings_sketch.get_apriori_error(k, wt)
     self.assertAlmostEqual(sk_apriori_error, reference_apriori_error, delta=1e-6)
 
+  def test_fi_strings_array_update(self):
+    fi = frequent_strings_sketch(6)
+    items = np.array(['a', 'b', 'a', 'c', 'a', 'b'])
+    fi.update_strings(items)
+    fi.update_strings(items.astype(object), 10)
+    self.assertEqual(fi.total_weight, 66)
+    self.assertEqual(fi.get_estimate('a'), 33)
+    self.assertEqual(fi.get_estimate('b'), 22)
+
+    offsets = np.array([0, 1, 3], dtype=np.int64)
+    fi.update_strings_from_buffers(offsets, b'abc')
+    self.assertEqual(fi.get_estimate('a'), 34)
+    self.assertEqual(fi.get_estimate('bc'), 1)
+
+    # a bad offset is reported before any string is counted
+    with self.assertRaises(IndexError):
+      fi.update_strings_from_buffers(np.array([0, 1, 2, 9], dtype=np.int64), b'abc')
+    self.assertEqual(fi.total_weight, 68)
+
+  def test_fi_merge_serialized(self):
+    # fewer distinct items than the sketch holds, so merging never purges and is exact
+    sketches = []
+    for i in range(8):
+      fi = frequent_strings_sketch(10)
+      fi.update_strings(np.array([str(j % (10 + 5 * i)) for j in range(1000)]))
+      sketches.append(fi)
+    blobs = [sk.serialize() for sk in sketches]
+
+    serial = frequent_strings_sketch(10)
+    serial.update('extra', 7)
+    for sk in sketches:
+      serial.merge(sk)
+    expected = sorted(serial.get_frequent_items(frequent_items_error_type.NO_FALSE_POSITIVES))
+
+    for num_threads in [1, 3, 0]:
+      merged = frequent_strings_sketch(10)
+      merged.update('extra', 7)
+      merged.merge_serialized(blobs, num_threads)
+      self.assertEqual(merged.total_weight, serial.total_weight)
+      self.assertEqual(sorted(merged.get_frequent_items(frequent_items_error_type.NO_FALSE_POSITIVES)), expected)
+
 if __name__ == '__main__':
   unittest.main()
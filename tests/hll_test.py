@@ -16,7 +16,10 @@
 # under the License.
 
 import unittest
+import numpy as np
+from concurrent.futures import ThreadPoolExecutor
 from datasketches import hll_sketch, hll_union, tgt_hll_type
+from datasketches import parallel_merge, SynchronizedSketch
 
 class HllTest(unittest.TestCase):
     def test_hll_example(self):
@@ -123,6 +126,129 @@ class HllTest(unittest.TestCase):
         self.assertTrue(isinstance(sk, hll_sketch))
         self.assertEqual(sk.tgt_type, tgt_hll_type.HLL_4)
         
+    def test_hll_array_update(self):
+        lgk = 10
+        n = 1 << 12
+        ints = np.arange(n, dtype=np.int64)
+        doubles = np.linspace(0.0, 1.0, n)
+
+        # array updates hash each element exactly as the scalar update does
+        hll = hll_sketch(lgk)
+        hll.update(ints)
+        hll.update(doubles)
+        hll_loop = hll_sketch(lgk)
+        for i in range(0, n):
+            hll_loop.update(i)
+            hll_loop.update(float(doubles[i]))
+        self.assertEqual(hll.get_estimate(), hll_loop.get_estimate())
+
+        # unsigned values hash the same bits as their signed counterparts,
+        # and strided views are read in place
+        union = hll_union(lgk)
+        union.update(ints[::2].astype(np.uint64))
+        union.update(ints[1::2])
+        hll_ints = hll_sketch(lgk)
+        hll_ints.update(ints)
+        self.assertEqual(union.get_estimate(), hll_ints.get_estimate())
+
+    def test_hll_string_array_update(self):
+        lgk = 10
+        words = ['alpha', 'beta', 'gamma', 'delta', 'epsilon', 'caf\u00e9', '\u65e5\u672c']
+        hll_loop = hll_sketch(lgk)
+        for w in words:
+            hll_loop.update(w)
+
+        # fixed-width unicode, object and bytes arrays all hash as the equivalent str
+        for items in [np.array(words),
+                      np.array(words, dtype=object),
+                      np.array([w.encode('utf-8') for w in words]),
+                      [w.encode('utf-8') for w in words] + [None]]:
+            hll = hll_sketch(lgk)
+            hll.update_strings(items)
+            self.assertEqual(hll.get_estimate(), hll_loop.get_estimate())
+
+        # variable-width layout as used by Apache Arrow
+        encoded = [w.encode('utf-8') for w in words]
+        offsets = np.cumsum([0] + [len(w) for w in encoded]).astype(np.int32)
+        union = hll_union(lgk)
+        union.update_strings_from_buffers(offsets, b''.join(encoded))
+        self.assertEqual(union.get_estimate(), hll_loop.get_estimate())
+
+        with self.assertRaises(TypeError):
+            hll.update_strings(np.arange(3))
+        # a single string is not split into characters
+        for items in ['abc', b'abc']:
+            with self.assertRaises(TypeError):
+                hll.update_strings(items)
+
+    def test_hll_deserialize_from_buffer(self):
+        hll = self.generate_sketch(5000, 12)
+        sk_bytes = hll.serialize_compact()
+
+        # any contiguous buffer-protocol object works, without copying into bytes
+        for buf in [bytearray(sk_bytes), memoryview(sk_bytes), np.frombuffer(sk_bytes, dtype=np.uint8)]:
+            self.assertEqual(hll_sketch.deserialize(buf).get_estimate(), hll.get_estimate())
+
+        # a sketch may also be read from a slice of a larger buffer
+        archive = b'header' + sk_bytes + b'trailer'
+        new_hll = hll_sketch.deserialize(archive, offset=6, length=len(sk_bytes))
+        self.assertEqual(new_hll.get_estimate(), hll.get_estimate())
+        new_hll = hll_sketch.deserialize(memoryview(archive)[:-7], 6)
+        self.assertEqual(new_hll.get_estimate(), hll.get_estimate())
+
+        with self.assertRaises(IndexError):
+            hll_sketch.deserialize(archive, offset=len(archive) + 1)
+        with self.assertRaises(IndexError):
+            hll_sketch.deserialize(archive, offset=6, length=len(archive))
+
+    def test_hll_union_update_serialized(self):
+        lgk = 12
+        n = 2000
+        sketches = [self.generate_sketch(n, lgk, tgt_hll_type.HLL_8, i * n // 2) for i in range(16)]
+        blobs = [sk.serialize_compact() for sk in sketches]
+
+        union = hll_union(lgk)
+        for sk in sketches:
+            union.update(sk)
+
+        # the registers do not depend on how the inputs are split across threads
+        for num_threads in [1, 3, 0]:
+            bulk_union = hll_union(lgk)
+            bulk_union.update_serialized(blobs, num_threads)
+            self.assertEqual(bulk_union.get_estimate(), union.get_estimate())
+
+        empty_union = hll_union(lgk)
+        empty_union.update_serialized([])
+        self.assertTrue(empty_union.is_empty())
+
+    def test_hll_synchronized(self):
+        lgk = 12
+        n = 1000
+        hll = SynchronizedSketch(hll_sketch(lgk))
+        union = SynchronizedSketch(hll_union(lgk))
+        others = [SynchronizedSketch(self.generate_sketch(n, lgk, st_idx=i * n)) for i in range(4)]
+
+        def ingest(i):
+            hll.update(np.arange(i * n, (i + 1) * n))
+            union.update(others[i % len(others)])
+
+        with ThreadPoolExecutor(max_workers=4) as executor:
+            list(executor.map(ingest, range(8)))
+
+        # the estimate depends on the order of the updates, so only the bounds are checked
+        self.assertLessEqual(hll.get_lower_bound(3), 8 * n)
+        self.assertGreaterEqual(hll.get_upper_bound(3), 8 * n)
+        self.assertEqual(union.get_result().get_estimate(),
+                         parallel_merge([sk.sketch for sk in others]).get_estimate())
+
+        # wrapped sketches in a list are unwrapped and locked by call()
+        merged = SynchronizedSketch.call(parallel_merge, others, num_threads=2)
+        self.assertEqual(merged.get_estimate(), union.get_result().get_estimate())
+
+        # an instance whose __init__ did not run reports missing attributes
+        uninitialized = SynchronizedSketch.__new__(SynchronizedSketch)
+        self.assertFalse(hasattr(uninitialized, 'update'))
+
     def generate_sketch(self, n, lgk, sk_type=tgt_hll_type.HLL_4, st_idx=0):
         sk = hll_sketch(lgk, sk_type)
         for i in range(st_idx, st_idx + n):
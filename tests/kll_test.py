@@ -15,11 +15,15 @@
 # specific language governing permissions and limitations
 # under the License.
 
+import sys
 import unittest
 from datasketches import kll_ints_sketch, kll_floats_sketch, kll_doubles_sketch
-from datasketches import kll_items_sketch, ks_test, PyStringsSerDe
+from datasketches import kll_longs_sketch, kll_ulongs_sketch, kll_strings_sketch, kll_keyed_items_sketch
+from datasketches import kll_items_sketch, ks_test, PyStringsSerDe, SynchronizedSketch
+from datasketches import parallel_merge
 import copy
 import numpy as np
+from concurrent.futures import ThreadPoolExecutor
 
 class KllTest(unittest.TestCase):
     def test_kll_floats_example(self):
@@ -126,6 +130,24 @@ class KllTest(unittest.TestCase):
         sk_bytes = kll.serialize()
         self.assertTrue(isinstance(kll_ints_sketch.deserialize(sk_bytes), kll_ints_sketch))
 
+    def test_kll_longs_sketch(self):
+      # nanosecond timestamps need all 64 bits, which neither float nor int32 hold exactly
+      base = 1_700_000_000_000_000_001
+      kll = kll_longs_sketch(200)
+      kll.update(np.arange(base, base + 1000, dtype=np.int64))
+      kll.update(base - 1)
+      self.assertEqual(kll.get_min_value(), base - 1)
+      self.assertEqual(kll.get_max_value(), base + 999)
+      self.assertEqual(kll.get_quantile(0.0), base - 1)
+      self.assertEqual(kll.n, 1001)
+
+      new_kll = kll_longs_sketch.deserialize(kll.serialize())
+      self.assertEqual(new_kll.get_quantile(0.5), kll.get_quantile(0.5))
+
+      ukll = kll_ulongs_sketch(200)
+      ukll.update(np.array([2 ** 64 - 1, 0], dtype=np.uint64))
+      self.assertEqual(ukll.get_max_value(), 2 ** 64 - 1)
+
     def test_kll_doubles_sketch(self):
       # already tested float and ints and it's templatized, so just make sure it instantiates properly
       k = 75
@@ -171,5 +193,327 @@ class KllTest(unittest.TestCase):
       self.assertGreater(len(kll.to_string(True, True)), 0)
       self.assertEqual(len(kll.__str__()), len(kll.to_string()))
 
+    def test_kll_strings_sketch(self):
+      kll = kll_strings_sketch(200)
+      words = ['w%05d' % i for i in range(10000)]
+      kll.update_strings(np.array(words))
+      kll.update('caf\u00e9')
+      self.assertEqual(kll.n, 10001)
+      self.assertEqual(kll.get_min_value(), 'w00000')
+      self.assertEqual(kll.get_max_value(), 'w09999')
+      self.assertAlmostEqual(kll.get_rank('w05000'), 0.5, delta=0.035)
+      self.assertTrue(kll.get_quantile(0.5).startswith('w0'))
+
+      # serialization needs no serde and matches the items sketch with PyStringsSerDe
+      new_kll = kll_strings_sketch.deserialize(kll.serialize())
+      self.assertEqual(new_kll.n, kll.n)
+      self.assertEqual(new_kll.get_quantiles([0.1, 0.5, 0.9]), kll.get_quantiles([0.1, 0.5, 0.9]))
+      items = kll_items_sketch.deserialize(kll.serialize(), PyStringsSerDe())
+      self.assertEqual(items.get_min_value(), kll.get_min_value())
+
+    def test_kll_keyed_items_sketch(self):
+      # tuples of (latency, host), ordered by latency alone
+      calls = []
+      def latency(item):
+        calls.append(item)
+        return item[0]
+
+      kll = kll_keyed_items_sketch(k=100, key=latency)
+      n = 10000
+      for i in range(n):
+        kll.update((float(n - i), 'host-%d' % (i % 7)))
+      # the key is computed once per update, never during compaction
+      self.assertEqual(len(calls), n)
+      self.assertTrue(kll.is_estimation_mode())
+      self.assertEqual(kll.get_min_value(), (1.0, 'host-%d' % ((n - 1) % 7)))
+      self.assertEqual(kll.get_max_value()[0], float(n))
+      self.assertAlmostEqual(kll.get_quantile(0.5)[0], n / 2, delta=0.05 * n)
+      self.assertAlmostEqual(kll.get_rank((n / 4, '')), 0.25, delta=0.05)
+      self.assertEqual(len(kll.get_cdf([(1000.0, ''), (2000.0, '')])), 3)
+      # sort keys may be given directly, without building items for the key function
+      num_calls = len(calls)
+      self.assertEqual(kll.get_rank_by_key(n / 4), kll.get_rank((n / 4, '')))
+      self.assertEqual(kll.get_cdf_by_key([1000.0, 2000.0]), kll.get_cdf([(1000.0, ''), (2000.0, '')]))
+      self.assertEqual(kll.get_pmf_by_key([1000.0, 2000.0]), kll.get_pmf([(1000.0, ''), (2000.0, '')]))
+      self.assertEqual(len(calls), num_calls + 5)
+      self.assertEqual(sum(w for _, w in kll), n)
+
+      # only the items are serialized, so a kll_items_sketch can read them as well
+      serde = PyStringsSerDe()
+      strings = kll_keyed_items_sketch(key=len)
+      for word in ['a', 'bbb', 'cc', 'dddd']:
+        strings.update(word)
+      self.assertEqual(strings.get_quantile(1.0, inclusive=True), 'dddd')
+      data = strings.serialize(serde)
+      self.assertEqual(len(data), strings.get_serialized_size_bytes(serde))
+      rebuilt = kll_keyed_items_sketch.deserialize(data, serde, key=len)
+      self.assertEqual(rebuilt.get_min_value(), 'a')
+      self.assertEqual(rebuilt.get_max_value(), 'dddd')
+      self.assertEqual(kll_items_sketch.deserialize(data, serde).n, 4)
+
+      # items without a key function are their own keys, and must be ints, floats, str or bytes
+      plain = kll_keyed_items_sketch()
+      plain.update(3)
+      plain.update(2.5)
+      self.assertEqual(plain.get_min_value(), 2.5)
+      with self.assertRaises(TypeError):
+        plain.update((1, 2))
+      with self.assertRaises(OverflowError):
+        plain.update(2 ** 64)
+      self.assertEqual(plain.n, 2)
+
+    def test_kll_serialize_into(self):
+      kll = kll_floats_sketch(200)
+      kll.update(np.random.normal(size=10000).astype(np.float32))
+      sk_bytes = kll.serialize()
+      self.assertEqual(len(sk_bytes), kll.get_serialized_size_bytes())
+
+      # several sketches may be packed into one preallocated buffer
+      buf = bytearray(10 + 2 * len(sk_bytes))
+      written = kll.serialize_into(buf, 10)
+      self.assertEqual(written, len(sk_bytes))
+      written += kll.serialize_into(memoryview(buf), 10 + written)
+      self.assertEqual(bytes(buf[10:10 + len(sk_bytes)]), sk_bytes)
+      new_kll = kll_floats_sketch.deserialize(buf, 10 + len(sk_bytes))
+      self.assertEqual(new_kll.get_quantile(0.5), kll.get_quantile(0.5))
+
+      # a buffer that is too small is left untouched
+      small = bytearray(b'\xff' * (len(sk_bytes) - 1))
+      with self.assertRaises(ValueError):
+        kll.serialize_into(small)
+      self.assertEqual(small, bytearray(b'\xff' * (len(sk_bytes) - 1)))
+      with self.assertRaises(BufferError):
+        kll.serialize_into(sk_bytes) # bytes are immutable
+
+      # items sketches take a serde
+      items = kll_items_sketch(100)
+      for i in range(1000):
+        items.update(str(i))
+      serde = PyStringsSerDe()
+      buf = bytearray(items.get_serialized_size_bytes(serde))
+      self.assertEqual(items.serialize_into(buf, serde), len(buf))
+      self.assertEqual(bytes(buf), items.serialize(serde))
+
+    def test_kll_merge_serialized(self):
+      sketches = []
+      for i in range(10):
+        kll = kll_doubles_sketch(200)
+        kll.update(np.random.normal(loc=i, size=5000))
+        sketches.append(kll)
+      blobs = [sk.serialize() for sk in sketches]
+
+      for num_threads in [1, 4]:
+        merged = kll_doubles_sketch(200)
+        merged.update(-100.0)
+        merged.merge_serialized(blobs, num_threads)
+        self.assertEqual(merged.n, 10 * 5000 + 1)
+        self.assertEqual(merged.get_min_value(), -100.0)
+        self.assertEqual(merged.get_max_value(), max(sk.get_max_value() for sk in sketches))
+        self.assertAlmostEqual(merged.get_quantile(0.5), 4.5, delta=0.5)
+
+      with self.assertRaises(Exception):
+        merged.merge_serialized([b'not a sketch'])
+
+    def test_kll_threaded_update(self):
+      data = np.random.uniform(size=1000000)
+      # every second value, as a strided view
+      values = data[::2]
+      for num_threads in [4, 0]:
+        kll = kll_doubles_sketch(200)
+        kll.update(-1.0)
+        kll.update(values, num_threads=num_threads)
+        self.assertEqual(kll.n, len(values) + 1)
+        self.assertEqual(kll.get_min_value(), -1.0)
+        self.assertEqual(kll.get_max_value(), values.max())
+        self.assertAlmostEqual(kll.get_quantile(0.5), 0.5, delta=kll.normalized_rank_error(False) * 2)
+
+    def test_kll_numpy_queries(self):
+      kll = kll_floats_sketch(200)
+      kll.update(np.random.normal(size=2 ** 14).astype(np.float32))
+
+      # numpy inputs give numpy outputs matching the list versions
+      ranks = np.linspace(0, 1, 101)
+      quantiles = kll.get_quantiles(ranks)
+      self.assertTrue(isinstance(quantiles, np.ndarray))
+      self.assertEqual(quantiles.dtype, np.float32)
+      self.assertEqual(list(quantiles), kll.get_quantiles(list(ranks)))
+
+      values = np.array([-1.0, 0.0, 1.0], dtype=np.float32)
+      self.assertEqual(list(kll.get_ranks(values)), [kll.get_rank(v) for v in values])
+      self.assertEqual(list(kll.get_ranks(values, inclusive=True)), [kll.get_rank(v, True) for v in values])
+      self.assertEqual(list(kll.get_cdf(values)), kll.get_cdf(list(values)))
+      self.assertEqual(list(kll.get_pmf(values)), kll.get_pmf(list(values)))
+
+      # strided arrays are read in place
+      self.assertEqual(list(kll.get_quantiles(ranks[::10])), list(quantiles[::10]))
+
+      # an empty sketch gives empty arrays, except for the PMF and CDF, which raise as with lists
+      empty = kll_floats_sketch(200)
+      self.assertEqual(len(empty.get_ranks(values)), 0)
+      self.assertEqual(len(empty.get_quantiles(ranks)), 0)
+      for split_points in [values, list(values)]:
+        with self.assertRaises(RuntimeError):
+          empty.get_pmf(split_points)
+        with self.assertRaises(RuntimeError):
+          empty.get_cdf(split_points)
+
+    def test_kll_weighted_update(self):
+      # a histogram of 1000 buckets with a total count of about 50 million
+      values = np.arange(1000, dtype=np.float64)
+      weights = np.random.randint(0, 100000, size=1000).astype(np.int64)
+      kll = kll_doubles_sketch(200)
+      kll.update(values, weights)
+      self.assertEqual(kll.n, weights.sum())
+
+      # compare against the exact cumulative distribution of the histogram
+      exact_cdf = np.cumsum(weights) / weights.sum()
+      for v in [100, 250, 500, 750, 900]:
+        self.assertAlmostEqual(kll.get_rank(v, inclusive=True), exact_cdf[v], delta=0.02)
+
+      # zero weights are skipped, while negative ones and mismatched lengths are rejected
+      kll.update(np.array([5000.0]), np.array([0], dtype=np.int64))
+      self.assertEqual(kll.get_max_value(), 999)
+      with self.assertRaises(ValueError):
+        kll.update(values, -weights)
+      with self.assertRaises(ValueError):
+        kll.update(values, weights[:10])
+
+    def test_kll_sorted_view(self):
+      kll = kll_doubles_sketch(200)
+      kll.update(np.random.normal(size=2 ** 14))
+      view = kll.sorted_view()
+      self.assertEqual(len(view), kll.num_retained)
+      self.assertFalse(view.is_empty())
+
+      for rank in [0.0, 0.1, 0.5, 0.9, 1.0]:
+        self.assertEqual(view.get_quantile(rank), kll.get_quantile(rank))
+      self.assertEqual(view.get_rank(0.0, inclusive=True), kll.get_rank(0.0, inclusive=True))
+      ranks = np.linspace(0, 1, 11)
+      self.assertEqual(list(view.get_quantiles(ranks)), list(kll.get_quantiles(ranks)))
+      split_points = np.array([-1.0, 0.0, 1.0])
+      self.assertEqual(list(view.get_ranks(split_points)), list(kll.get_ranks(split_points)))
+      self.assertEqual(list(view.get_cdf(split_points)), list(kll.get_cdf(split_points)))
+      self.assertEqual(list(view.get_pmf(split_points)), list(kll.get_pmf(split_points)))
+
+      # items are sorted and the cumulative weights end at n
+      items, weights = view.to_numpy()
+      self.assertEqual(len(items), len(view))
+      self.assertTrue(np.all(items[:-1] <= items[1:]))
+      self.assertTrue(np.all(weights[:-1] < weights[1:]))
+      self.assertEqual(weights[-1], kll.n)
+
+      # the snapshot does not follow later updates
+      median = view.get_quantile(0.5)
+      kll.update(np.full(2 ** 15, 100.0))
+      self.assertEqual(view.get_quantile(0.5), median)
+      self.assertEqual(kll.sorted_view().get_quantile(0.5), 100.0)
+
+      # and may be queried from many threads
+      with ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(executor.map(lambda _: list(view.get_quantiles(ranks)), range(8)))
+      for result in results:
+        self.assertEqual(result, results[0])
+
+    def test_kll_parallel_merge(self):
+      sketches = []
+      for i in range(20):
+        kll = kll_doubles_sketch(200)
+        kll.update(np.random.normal(loc=i, size=2000))
+        sketches.append(kll)
+
+      for num_threads in [1, 4, 0]:
+        merged = parallel_merge(sketches, num_threads=num_threads)
+        self.assertTrue(isinstance(merged, kll_doubles_sketch))
+        self.assertEqual(merged.n, 20 * 2000)
+        self.assertEqual(merged.get_min_value(), min(sk.get_min_value() for sk in sketches))
+        self.assertEqual(merged.get_max_value(), max(sk.get_max_value() for sk in sketches))
+        self.assertAlmostEqual(merged.get_quantile(0.5), 9.5, delta=0.5)
+
+      # the inputs are left untouched
+      self.assertEqual(sketches[0].n, 2000)
+
+      with self.assertRaises(TypeError):
+        parallel_merge([sketches[0], kll_floats_sketch(200)])
+      with self.assertRaises(ValueError):
+        parallel_merge([])
+
+    def test_kll_concurrent_queries(self):
+      # queries may run from many threads at once, and must all see the same sketch
+      kll = kll_floats_sketch(200)
+      kll.update(np.random.normal(size=2 ** 16))
+      ranks = [0.1, 0.25, 0.5, 0.75, 0.9]
+      split_points = [-1.0, 0.0, 1.0]
+
+      def query(_):
+        return (kll.get_quantiles(ranks), kll.get_cdf(split_points), kll.get_rank(0.0))
+
+      with ThreadPoolExecutor(max_workers=4) as executor:
+        results = list(executor.map(query, range(16)))
+
+      expected = (kll.get_quantiles(ranks), kll.get_cdf(split_points), kll.get_rank(0.0))
+      for result in results:
+        self.assertEqual(result, expected)
+
+      other = kll_floats_sketch(200)
+      other.update(np.random.normal(size=2 ** 12))
+      kll.merge(other)
+      self.assertEqual(kll.n, 2 ** 16 + 2 ** 12)
+
+    @unittest.skipUnless(getattr(sys, '_is_gil_enabled', lambda: True)(),
+                         'without the GIL a shared sketch must be wrapped in a SynchronizedSketch')
+    def test_kll_merge_during_update(self):
+      # merging reads the other sketch, which keeps changing in other threads
+      target = kll_doubles_sketch(200)
+      source = kll_doubles_sketch(200)
+      source.update(0.5)
+      num_batches = 32
+      batch_size = 10000
+      num_merges = 64
+
+      def update(i):
+        source.update(np.random.uniform(size=batch_size))
+        source.update(np.random.uniform(size=batch_size), num_threads=2)
+        source.update(float(i) / num_batches)
+
+      def merge(_):
+        target.merge(source)
+        target.get_quantiles([0.25, 0.5, 0.75])
+
+      with ThreadPoolExecutor(max_workers=8) as executor:
+        futures = [executor.submit(update, i) for i in range(num_batches)]
+        futures += [executor.submit(merge, i) for i in range(num_merges)]
+        for future in futures:
+          future.result()
+
+      self.assertEqual(source.n, num_batches * (2 * batch_size + 1) + 1)
+      self.assertGreaterEqual(target.n, num_merges)
+      self.assertLessEqual(target.n, num_merges * source.n)
+      self.assertGreaterEqual(target.get_min_value(), 0.0)
+      self.assertLess(target.get_max_value(), 1.0)
+      restored = kll_doubles_sketch.deserialize(target.serialize())
+      self.assertEqual(restored.n, target.n)
+      self.assertEqual(restored.get_quantile(0.5), target.get_quantile(0.5))
+
+    def test_kll_synchronized_updates(self):
+      # a wrapped sketch may be updated and merged into from many threads
+      kll = SynchronizedSketch(kll_floats_sketch(200))
+      other = SynchronizedSketch(kll_floats_sketch(200))
+      other.update(np.arange(1000, dtype=np.float32))
+      num_batches = 16
+      batch_size = 1000
+
+      def ingest(i):
+        kll.update(np.random.normal(size=batch_size).astype(np.float32))
+        kll.merge(other)
+        kll.update(float(i))
+
+      with ThreadPoolExecutor(max_workers=4) as executor:
+        list(executor.map(ingest, range(num_batches)))
+
+      self.assertEqual(kll.n, num_batches * (2 * batch_size + 1))
+      self.assertFalse(kll.is_empty())
+      self.assertTrue(isinstance(kll.sketch, kll_floats_sketch))
+      self.assertEqual(len(str(kll)), len(kll.to_string()))
+
 if __name__ == '__main__':
     unittest.main()
@@ -171,5 +171,35 @@ class QuantilesTest(unittest.TestCase):
       self.assertGreater(len(quantiles.to_string(True, True)), 0)
       self.assertEqual(len(quantiles.__str__()), len(quantiles.to_string()))
 
+    def test_quantiles_merge_serialized(self):
+      ranks = [i / 100 for i in range(101)]
+      for size in [20, 10000]:
+        # small inputs are merged without any compaction, so the result is exact
+        sketches = []
+        for i in range(8):
+          quantiles = quantiles_doubles_sketch(128)
+          quantiles.update(np.random.normal(loc=i, size=size))
+          sketches.append(quantiles)
+        blobs = [sk.serialize() for sk in sketches]
+
+        serial = quantiles_doubles_sketch(128)
+        for sk in sketches:
+          serial.merge(sk)
+
+        for num_threads in [1, 3]:
+          merged = quantiles_doubles_sketch(128)
+          merged.merge_serialized(blobs, num_threads)
+          self.assertEqual(merged.n, serial.n)
+          self.assertEqual(merged.num_retained, serial.num_retained)
+          self.assertEqual(merged.get_min_value(), serial.get_min_value())
+          self.assertEqual(merged.get_max_value(), serial.get_max_value())
+          if not serial.is_estimation_mode():
+            self.assertEqual(merged.get_quantiles(ranks), serial.get_quantiles(ranks))
+          else:
+            # compaction is randomized, so larger inputs agree within the rank error
+            error = 2 * serial.get_normalized_rank_error(False)
+            for v in serial.get_quantiles(ranks[1:-1]):
+              self.assertAlmostEqual(merged.get_rank(v), serial.get_rank(v), delta=error)
+
 if __name__ == '__main__':
     unittest.main()
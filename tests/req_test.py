@@ -17,6 +17,7 @@
 
 import unittest
 from datasketches import req_ints_sketch, req_floats_sketch, req_items_sketch, PyStringsSerDe
+from datasketches import req_doubles_sketch, req_longs_sketch, req_ulongs_sketch
 import copy
 import numpy as np
 
@@ -132,6 +133,15 @@ class reqTest(unittest.TestCase):
       self.assertTrue(req.is_empty())
       self.assertFalse(req.is_hra())
 
+    def test_req_64bit_sketches(self):
+      # already tested the templated code, so just make sure these instantiate properly
+      for sketch_type in [req_doubles_sketch, req_longs_sketch, req_ulongs_sketch]:
+        req = sketch_type(12)
+        req.update(np.arange(100).astype(np.uint64))
+        self.assertEqual(req.n, 100)
+        self.assertEqual(req.get_max_value(), 99)
+        self.assertTrue(isinstance(sketch_type.deserialize(req.serialize()), sketch_type))
+
     def test_req_items_sketch(self):
       # most functionality has been tested, but we need to ensure objects and sorting work
       # as well as serialization
@@ -166,5 +176,35 @@ class reqTest(unittest.TestCase):
       self.assertGreater(len(req.to_string(True, True)), 0)
       self.assertEqual(len(req.__str__()), len(req.to_string()))
 
+    def test_req_merge_serialized(self):
+      ranks = [i / 100 for i in range(101)]
+      for size in [5, 10000]:
+        # small inputs are merged without any compaction, so the result is exact
+        sketches = []
+        for i in range(8):
+          req = req_floats_sketch(12)
+          req.update(np.random.normal(loc=i, size=size).astype(np.float32))
+          sketches.append(req)
+        blobs = [sk.serialize() for sk in sketches]
+
+        serial = req_floats_sketch(12)
+        for sk in sketches:
+          serial.merge(sk)
+
+        for num_threads in [1, 3]:
+          merged = req_floats_sketch(12)
+          merged.merge_serialized(blobs, num_threads)
+          self.assertEqual(merged.n, serial.n)
+          self.assertEqual(merged.get_min_value(), serial.get_min_value())
+          self.assertEqual(merged.get_max_value(), serial.get_max_value())
+          if not serial.is_estimation_mode():
+            self.assertEqual(merged.get_quantiles(ranks), serial.get_quantiles(ranks))
+          else:
+            # compaction is randomized, so larger inputs agree within the rank bounds
+            for v in serial.get_quantiles(ranks[1:-1]):
+              rank = serial.get_rank(v)
+              error = serial.get_rank_upper_bound(rank, 3) - serial.get_rank_lower_bound(rank, 3)
+              self.assertAlmostEqual(merged.get_rank(v), rank, delta=error)
+
 if __name__ == '__main__':
     unittest.main()
@@ -79,6 +79,49 @@ class TdigestTest(unittest.TestCase):
       self.assertEqual(td.get_quantile(0.7), new_td.get_quantile(0.7))
       self.assertEqual(td.get_rank(0.0), new_td.get_rank(0.0))
 
+    def test_tdigest_array_update(self):
+      # by default a large array updates the sketch directly, as a loop would
+      values = np.random.normal(size=100000)
+      td = tdigest_double()
+      td.update(values)
+      td_loop = tdigest_double()
+      for v in values:
+        td_loop.update(v)
+      self.assertEqual(td.serialize(), td_loop.serialize())
+
+      # num_threads is keyword-only, so a one-centroid weight is never taken for it
+      td = tdigest_double()
+      td.update(np.array([5.0]), np.array([3]))
+      self.assertEqual(td.get_total_weight(), 3)
+      with self.assertRaises(TypeError):
+        td.update(values, 2)
+
+    def test_tdigest_centroids(self):
+      # centroids exported from another digest, as (mean, weight) arrays
+      means = np.linspace(-3.0, 3.0, 601)
+      weights = np.round(1000 * np.exp(-means ** 2 / 2))
+      td = tdigest_double()
+      td.update(means, weights)
+      self.assertEqual(td.get_total_weight(), weights.sum())
+      self.assertEqual(td.get_min_value(), -3.0)
+      self.assertEqual(td.get_max_value(), 3.0)
+
+      # numpy queries agree with the scalar ones
+      ranks = np.array([0.1, 0.5, 0.9])
+      quantiles = td.get_quantiles(ranks)
+      self.assertAlmostEqual(quantiles[1], 0.0, delta=0.05)
+      np.testing.assert_equal(quantiles, [td.get_quantile(r) for r in ranks])
+      np.testing.assert_equal(td.get_ranks(quantiles), [td.get_rank(q) for q in quantiles])
+      self.assertEqual(len(tdigest_double().get_quantiles(ranks)), 0)
+
+      # zero weights and NaN means are skipped, fractional weights are rejected
+      td.update(np.array([np.nan, 10.0]), np.array([5, 0]))
+      self.assertEqual(td.get_total_weight(), weights.sum())
+      with self.assertRaises(ValueError):
+        td.update(np.array([1.0]), np.array([0.5]))
+      with self.assertRaises(ValueError):
+        td.update(np.array([1.0, 2.0]), np.array([1.0]))
+
 
     # the same tests as above, but with tdigest_float
     def test_tdigest_float_example(self):
@@ -121,3 +164,25 @@ class TdigestTest(unittest.TestCase):
       self.assertEqual(td.get_max_value(), new_td.get_max_value())
       self.assertEqual(td.get_quantile(0.7), new_td.get_quantile(0.7))
       self.assertEqual(td.get_rank(0.0), new_td.get_rank(0.0))
+
+    def test_tdigest_merge_serialized(self):
+      sketches = []
+      for i in range(8):
+        td = tdigest_double(100)
+        td.update(np.random.normal(loc=i, size=10000))
+        sketches.append(td)
+      blobs = [sk.serialize() for sk in sketches]
+
+      serial = tdigest_double(100)
+      for sk in sketches:
+        serial.merge(sk)
+
+      # centroids are combined in a different order, so only the totals match exactly
+      for num_threads in [1, 3]:
+        merged = tdigest_double(100)
+        merged.merge_serialized(blobs, num_threads)
+        self.assertEqual(merged.get_total_weight(), serial.get_total_weight())
+        self.assertEqual(merged.get_min_value(), serial.get_min_value())
+        self.assertEqual(merged.get_max_value(), serial.get_max_value())
+        for rank in [0.05, 0.25, 0.5, 0.75, 0.95]:
+          self.assertAlmostEqual(merged.get_quantile(rank), serial.get_quantile(rank), delta=0.05)
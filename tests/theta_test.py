@@ -16,11 +16,12 @@
 # under the License.
 
 import unittest
+import numpy as np
 
 from datasketches import update_theta_sketch
 from datasketches import compact_theta_sketch, theta_union
 from datasketches import theta_intersection, theta_a_not_b
-from datasketches import theta_jaccard_similarity
+from datasketches import theta_jaccard_similarity, parallel_merge
 
 class ThetaTest(unittest.TestCase):
     def test_theta_basic_example(self):
@@ -160,6 +161,56 @@ class ThetaTest(unittest.TestCase):
         self.assertTrue(theta_jaccard_similarity.similarity_test(sk1, result, 0.7))
 
 
+    def test_theta_array_update(self):
+        lgk = 10
+        n = 1 << 14
+
+        # array updates hash each element exactly as the scalar update does,
+        # so the resulting sketches are identical
+        sk = update_theta_sketch(lgk)
+        sk.update(np.arange(n, dtype=np.int64))
+        sk_loop = self.generate_theta_sketch(n, lgk)
+        self.assertTrue(theta_jaccard_similarity.exactly_equal(sk, sk_loop))
+
+        # strided views of a 2D array are read in place
+        matrix = np.arange(2 * n, dtype=np.float64).reshape(n, 2)
+        sk = update_theta_sketch(lgk)
+        sk.update(matrix[:, 1])
+        sk_loop = update_theta_sketch(lgk)
+        for value in matrix[:, 1]:
+            sk_loop.update(float(value))
+        self.assertTrue(sk.is_estimation_mode())
+        self.assertTrue(theta_jaccard_similarity.exactly_equal(sk, sk_loop))
+
+    def test_theta_union_update_serialized(self):
+        lgk = 12
+        n = 1000
+        sketches = [self.generate_theta_sketch(n, lgk, i * n // 2) for i in range(8)]
+        blobs = [sk.compact().serialize() for sk in sketches]
+        blobs[1] = sketches[1].compact().serialize(compress=True)
+
+        union = theta_union(lgk)
+        for sk in sketches:
+          union.update(sk)
+
+        bulk_union = theta_union(lgk)
+        bulk_union.update_serialized(blobs)
+        self.assertTrue(theta_jaccard_similarity.exactly_equal(bulk_union.get_result(), union.get_result()))
+
+    def test_theta_parallel_merge(self):
+        lgk = 12
+        n = 1000
+        sketches = [self.generate_theta_sketch(n, lgk, i * n // 2) for i in range(16)]
+        sketches[3] = sketches[3].compact()
+
+        union = theta_union(lgk)
+        for sk in sketches:
+          union.update(sk)
+
+        merged = parallel_merge(sketches, num_threads=4)
+        self.assertTrue(isinstance(merged, compact_theta_sketch))
+        self.assertTrue(theta_jaccard_similarity.exactly_equal(merged, union.get_result()))
+
     def generate_theta_sketch(self, n, lgk, offset=0):
       sk = update_theta_sketch(lgk)
       for i in range(0, n):
@@ -16,10 +16,18 @@
 # under the License.
 
 import unittest
+from datasketches import kll_floats_sketch, kll_doubles_sketch, ks_test, ks_test_many
 from datasketches import (vector_of_kll_ints_sketches,
-                          vector_of_kll_floats_sketches)
+                          vector_of_kll_floats_sketches,
+                          vector_of_kll_doubles_sketches,
+                          vector_of_kll_longs_sketches,
+                          vector_of_kll_doubles_arena_sketches,
+                          vector_of_quantiles_doubles_sketches,
+                          vector_of_req_floats_sketches,
+                          vector_of_tdigest_doubles)
 import copy
 import numpy as np
+from concurrent.futures import ThreadPoolExecutor
 
 class VectorOfKllSketchesTest(unittest.TestCase):
     def test_vector_of_kll_floats_sketches_example(self):
@@ -97,6 +105,18 @@ class VectorOfKllSketchesTest(unittest.TestCase):
       kll = vector_of_kll_ints_sketches(k, d)
       self.assertTrue(np.all(kll.is_empty()))
 
+    def test_kll_64bit_sketches(self):
+      k = 100
+      d = 3
+      kll = vector_of_kll_doubles_sketches(k, d)
+      kll.update(np.random.randn(1000, d))
+      self.assertTrue(np.all(kll.get_n() == 1000))
+
+      base = 2 ** 62
+      kll = vector_of_kll_longs_sketches(k, d)
+      kll.update(np.arange(base, base + 3 * 1000, dtype=np.int64).reshape(1000, d))
+      np.testing.assert_equal(kll.get_min_values(), [base, base + 1, base + 2])
+
     def test_kll_2Dupdates(self):
       # 1D case tested in the first example
       # 2D case will follow same idea, but focusing on update()
@@ -132,6 +152,224 @@ class VectorOfKllSketchesTest(unittest.TestCase):
       self.assertEqual(len(kll.__str__()), len(kll.to_string()))
 
 
+    def test_kll_threaded_updates(self):
+      # enough dimensions to span several groups of columns, with k
+      # large enough that no sketch compacts and results are exact
+      k = 4096
+      d = 40
+      n = 2000
+      data = np.random.randn(n, d)
+      data[::10, 3] = np.nan # missing values are skipped
+
+      expected = vector_of_kll_doubles_sketches(k, d)
+      for row in data:
+        expected.update(row)
+
+      for arr in [data, np.asfortranarray(data), data[:, ::-1][:, ::-1]]:
+        for num_threads in [1, 4, 0]:
+          kll = vector_of_kll_doubles_sketches(k, d)
+          kll.update(arr, num_threads=num_threads)
+          np.testing.assert_equal(kll.get_n(), expected.get_n())
+          self.assertEqual(kll.get_n()[3], n - n // 10)
+          np.testing.assert_equal(kll.get_min_values(), expected.get_min_values())
+          np.testing.assert_equal(kll.get_max_values(), expected.get_max_values())
+          np.testing.assert_equal(kll.get_quantiles(0.5), expected.get_quantiles(0.5))
+
+    def test_kll_serialize_all(self):
+      k = 200
+      d = 25
+      kll = vector_of_kll_doubles_sketches(k, d)
+      kll.update(np.random.randn(5000, d) + np.arange(d))
+
+      blob = kll.serialize_all()
+      for num_threads in [1, 4]:
+        new_kll = vector_of_kll_doubles_sketches.deserialize_all(blob, num_threads=num_threads)
+        self.assertEqual(new_kll.k, k)
+        self.assertEqual(new_kll.d, d)
+        np.testing.assert_equal(kll.get_num_retained(), new_kll.get_num_retained())
+        np.testing.assert_equal(kll.get_quantiles(0.5), new_kll.get_quantiles(0.5))
+
+      # a slice of a larger buffer, and random access to a single dimension
+      padded = memoryview(b'xyz' + blob + b'abc')
+      new_kll = vector_of_kll_doubles_sketches.deserialize_all(padded, 3, len(blob))
+      np.testing.assert_equal(kll.get_max_values(), new_kll.get_max_values())
+      sk = vector_of_kll_doubles_sketches.deserialize_sketch(padded, 7, 3)
+      self.assertEqual(sk.serialize(), kll.serialize(7)[0])
+
+      with self.assertRaises(ValueError):
+        vector_of_kll_doubles_sketches.deserialize_sketch(blob, d)
+      with self.assertRaises(ValueError):
+        vector_of_kll_floats_sketches.deserialize_all(blob)
+      with self.assertRaises(IndexError):
+        vector_of_kll_doubles_sketches.deserialize_all(blob[:len(blob) - 1])
+
+    def test_kll_parallel_queries(self):
+      k = 200
+      d = 30
+      kll = vector_of_kll_doubles_sketches(k, d)
+      kll.update(np.random.randn(20000, d) + np.arange(d))
+      singles = [kll_doubles_sketch.deserialize(b) for b in kll.serialize()]
+
+      ranks = [0.01, 0.25, 0.5, 0.75, 0.99]
+      isk = [5, 0, 5, 29]
+      for inclusive in [True, False]:
+        for num_threads in [1, 4, 0]:
+          quants = kll.get_quantiles(ranks, isk, inclusive, num_threads)
+          pts = np.median(quants, axis=0)
+          ranks_out = kll.get_ranks(pts, isk, inclusive=inclusive, num_threads=num_threads)
+          pmf = kll.get_pmf(pts, isk, inclusive=inclusive, num_threads=num_threads)
+          cdf = kll.get_cdf(pts, isk, inclusive=inclusive, num_threads=num_threads)
+          for row, i in enumerate(isk):
+            np.testing.assert_equal(quants[row], singles[i].get_quantiles(ranks, inclusive))
+            np.testing.assert_equal(ranks_out[row], [singles[i].get_rank(p, inclusive) for p in pts])
+            np.testing.assert_equal(pmf[row], singles[i].get_pmf(pts, inclusive))
+            np.testing.assert_equal(cdf[row], singles[i].get_cdf(pts, inclusive))
+
+    def test_kll_grouped_updates(self):
+      k = 200
+      kll = vector_of_kll_doubles_sketches(k, 2)
+      group_ids = np.array([0, 1, 1, 0, 1])
+      values = np.array([1.0, 10.0, np.nan, 3.0, 20.0])
+      kll.update_grouped(group_ids, values)
+      np.testing.assert_equal(kll.get_n(), [2, 2])
+      np.testing.assert_equal(kll.get_max_values(), [3.0, 20.0])
+
+      # a new group appears
+      self.assertEqual(kll.add_dimensions(1), 3)
+      self.assertEqual(kll.d, 3)
+      self.assertTrue(kll.is_empty()[2])
+      kll.update_grouped(np.array([2, 2], dtype=np.int32), np.array([5.0, 7.0]))
+      np.testing.assert_equal(kll.get_n(), [2, 2, 2])
+      np.testing.assert_equal(kll.get_min_values(), [1.0, 10.0, 5.0])
+
+      # invalid ids and mismatched lengths update nothing
+      with self.assertRaises(ValueError):
+        kll.update_grouped(np.array([0, 3]), np.array([1.0, 2.0]))
+      with self.assertRaises(ValueError):
+        kll.update_grouped(np.array([0, 1]), np.array([1.0]))
+      np.testing.assert_equal(kll.get_n(), [2, 2, 2])
+
+    def test_kll_concurrent_growth(self):
+      # dimensions are added while other threads update and query the existing ones
+      kll = vector_of_kll_doubles_sketches(200, 2)
+      num_batches = 32
+      batch_size = 1000
+
+      def work(i):
+        if i % 4 == 0:
+          kll.add_dimensions(1)
+        kll.update_grouped(np.array([0, 1] * (batch_size // 2)), np.random.uniform(size=batch_size))
+        kll.serialize_all()
+        kll.get_quantiles([0.5], isk=[0, 1], num_threads=2)
+
+      with ThreadPoolExecutor(max_workers=8) as executor:
+        list(executor.map(work, range(num_batches)))
+
+      self.assertEqual(kll.d, 2 + num_batches // 4)
+      self.assertEqual(sum(kll.get_n()[:2]), num_batches * batch_size)
+      self.assertTrue(np.all(kll.is_empty()[2:]))
+
+    def test_kll_arena_sketches(self):
+      k = 200
+      d = 1000
+      data = np.random.randn(300, d)
+      kll = vector_of_kll_doubles_arena_sketches(k, d)
+      # all sketches share the arena and its single mutex, so the threads
+      # update in parallel but still take turns whenever they allocate
+      kll.update(data, num_threads=4)
+      self.assertGreater(kll.allocated_bytes, 0)
+
+      # growing sketches left their first arrays on the arena's free lists,
+      # which compacting into a new arena gives back
+      reserved = kll.reserved_bytes
+      kll.compact()
+      self.assertLess(kll.reserved_bytes, reserved)
+      self.assertLessEqual(kll.allocated_bytes, kll.reserved_bytes)
+
+      # results match sketches using the default allocator
+      expected = vector_of_kll_doubles_sketches(k, d)
+      expected.update(data)
+      np.testing.assert_equal(kll.get_min_values(), expected.get_min_values())
+      np.testing.assert_equal(kll.get_n(), expected.get_n())
+      self.assertEqual(kll.collapse().n, 300 * d)
+
+      # a copy has an arena of its own
+      kll_copy = copy.copy(kll)
+      kll.merge(kll_copy)
+      np.testing.assert_equal(kll.get_n(), 600)
+      np.testing.assert_equal(kll_copy.get_n(), 300)
+      kll.compact()
+      self.assertLessEqual(kll.allocated_bytes, kll.reserved_bytes)
+      np.testing.assert_equal(kll.get_n(), 600)
+
+      new_kll = vector_of_kll_doubles_arena_sketches.deserialize_all(kll.serialize_all())
+      np.testing.assert_equal(kll.get_quantiles(0.5), new_kll.get_quantiles(0.5))
+      new_kll.deserialize(expected.serialize(0)[0], 0)
+      self.assertEqual(new_kll.get_n()[0], 300)
+
+    def test_vector_of_other_sketches(self):
+      d = 3
+      n = 1000
+      dat = np.arange(n * d, dtype=np.float64).reshape(n, d)
+
+      quantiles = vector_of_quantiles_doubles_sketches(d=d)
+      req = vector_of_req_floats_sketches(k=12, d=d, is_hra=False)
+      tdigest = vector_of_tdigest_doubles(d=d)
+      for vec in [quantiles, req, tdigest]:
+        vec.update(dat.astype(np.float32) if vec is req else dat)
+        np.testing.assert_equal(vec.get_n(), n)
+        np.testing.assert_equal(vec.get_min_values(), dat.min(axis=0))
+        np.testing.assert_equal(vec.get_max_values(), dat.max(axis=0))
+        ranks = vec.get_ranks(float(d * n // 2))
+        self.assertEqual(ranks.shape, (d, 1))
+        self.assertAlmostEqual(ranks[0, 0], 0.5, delta=0.05)
+        collapsed = vec.collapse()
+        self.assertEqual(collapsed.get_total_weight() if vec is tdigest else collapsed.n, n * d)
+
+        # the blob records the family, so another vector type rejects it
+        blob = vec.serialize_all()
+        new_vec = type(vec).deserialize_all(blob)
+        np.testing.assert_equal(new_vec.get_quantiles([0.1, 0.9]), vec.get_quantiles([0.1, 0.9]))
+        with self.assertRaises(ValueError):
+          vector_of_kll_doubles_sketches.deserialize_all(blob)
+
+      self.assertFalse(req.collapse().is_hra())
+      self.assertEqual(req.k, 12)
+      np.testing.assert_equal(quantiles.is_estimation_mode(), True)
+
+    def test_ks_test_many(self):
+      d = 4
+      n = 5000
+      baseline = vector_of_kll_doubles_sketches(200, d)
+      current = vector_of_kll_doubles_sketches(200, d)
+      baseline.update(np.random.randn(n, d))
+      # only the last two features drift
+      shifted = np.random.randn(n, d)
+      shifted[:, 2:] += 2
+      current.update(shifted)
+
+      rejected, statistics = ks_test_many(baseline, current, 0.001, num_threads=2)
+      np.testing.assert_equal(rejected, [False, False, True, True])
+      self.assertEqual(statistics.shape, (d,))
+      self.assertTrue(np.all(statistics[2:] > statistics[:2]))
+
+      # lists of sketches give the same answers as the scalar test, and may share a baseline
+      sketches = [kll_doubles_sketch(200) for _ in range(3)]
+      for i, sk in enumerate(sketches):
+        sk.update(np.random.randn(n) + i)
+      rejected, statistics = ks_test_many([sketches[0]] * 3, sketches, 0.001, num_threads=0)
+      np.testing.assert_equal(rejected, [ks_test(sketches[0], sk, 0.001) for sk in sketches])
+      self.assertEqual(statistics[0], 0)
+
+      # every element is checked, not only the first
+      with self.assertRaises(TypeError):
+        ks_test_many(sketches, [sketches[0], sketches[1], 'not a sketch'], 0.001)
+      with self.assertRaises(TypeError):
+        ks_test_many(sketches, sketches[:2] + [kll_floats_sketch(200)], 0.001)
+
+      with self.assertRaises(ValueError):
+        ks_test_many(baseline, vector_of_kll_doubles_sketches(200, d + 1), 0.001)
+
     def test_kll_3Dupdates(self):
       # now test 3D update, which should fail
       k = 200
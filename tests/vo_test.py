@@ -16,7 +16,53 @@
 # under the License.
  
 import unittest
+import struct
+import numpy as np
 from datasketches import var_opt_sketch, var_opt_union, PyIntsSerDe, PyStringsSerDe
+from datasketches import PyLongsSerDe, PyFloatsSerDe, PyDoublesSerDe, PyObjectSerDe
+
+class BatchedLongsSerDe(PyObjectSerDe):
+  '''A custom serde using the optional batched methods, counting the calls to each'''
+  def __init__(self):
+    PyObjectSerDe.__init__(self)
+    self.calls = 0
+
+  def get_size(self, item):
+    return 8
+
+  def to_bytes(self, item):
+    self.calls += 1
+    return struct.pack('<q', item)
+
+  def from_bytes(self, data: bytes, offset: int):
+    self.calls += 1
+    return (struct.unpack_from('<q', data, offset)[0], 8)
+
+  def to_bytes_many(self, items):
+    self.calls += 1
+    return struct.pack(f'<{len(items)}q', *items)
+
+  def from_bytes_many(self, data, offset: int, count: int):
+    self.calls += 1
+    return (list(struct.unpack_from(f'<{count}q', data, offset)), 8 * count)
+
+class KeepingLongsSerDe(BatchedLongsSerDe):
+  '''A batched serde keeping an array over the data, which it must not do'''
+  def from_bytes_many(self, data, offset: int, count: int):
+    self.kept = np.frombuffer(data, dtype='<i8', count=count, offset=offset)
+    return (self.kept.tolist(), 8 * count)
+
+class PrefixedStringsSerDe(PyStringsSerDe):
+  '''A subclass of a native serde overriding its per-item methods'''
+  def get_size(self, item):
+    return PyStringsSerDe.get_size(self, 'x' + item)
+
+  def to_bytes(self, item):
+    return PyStringsSerDe.to_bytes(self, 'x' + item)
+
+  def from_bytes(self, data: bytes, offset: int):
+    item, size = PyStringsSerDe.from_bytes(self, data, offset)
+    return (item[1:], size)
 
 class VoTest(unittest.TestCase):
   def test_vo_example(self):
@@ -137,5 +183,69 @@ class VoTest(unittest.TestCase):
 
 
 
+  def test_vo_native_serdes(self):
+    # the provided serdes use the same formats as struct.pack
+    self.assertEqual(PyIntsSerDe().to_bytes(-3), struct.pack('<i', -3))
+    self.assertEqual(PyLongsSerDe().to_bytes(2 ** 40), struct.pack('<q', 2 ** 40))
+    self.assertEqual(PyDoublesSerDe().to_bytes(0.1), struct.pack('<d', 0.1))
+    self.assertEqual(PyFloatsSerDe().from_bytes(struct.pack('<f', 0.5), 0), (0.5, 4))
+    self.assertEqual(PyStringsSerDe().to_bytes('abc'), b'\x03\x00\x00\x00abc')
+    self.assertEqual(PyStringsSerDe().get_size('caf\u00e9'), 9)
+    self.assertEqual(PyStringsSerDe().from_bytes(b'xx\x02\x00\x00\x00\xc3\xa9', 2), ('\u00e9', 6))
+
+    # strings are encoded as UTF-8
+    k = 100
+    vo = var_opt_sketch(k)
+    for i in range(0, 2 * k):
+      vo.update('caf\u00e9 ' + str(i), 1.0 + i)
+    serde = PyStringsSerDe()
+    b = vo.serialize(serde)
+    self.assertEqual(vo.get_serialized_size_bytes(serde), len(b))
+    rebuilt = var_opt_sketch.deserialize(b, serde)
+    self.assertEqual(sorted(vo), sorted(rebuilt))
+
+    # truncated input is rejected rather than read past its end
+    with self.assertRaises(Exception):
+      var_opt_sketch.deserialize(b[:-1], serde)
+
+  def test_vo_batched_serde(self):
+    k = 100
+    vo = var_opt_sketch(k)
+    for i in range(0, 10 * k):
+      vo.update(i, 1.0 + i % 7)
+
+    # a few heavy items, so that both regions of the sample hold items
+    for i in range(0, 5):
+      vo.update(-i, 1e9)
+
+    serde = BatchedLongsSerDe()
+    b = vo.serialize(serde)
+    self.assertEqual(b, vo.serialize(PyLongsSerDe()))
+    # heavy and light samples are stored separately, with one call each
+    self.assertEqual(serde.calls, 2)
+
+    serde.calls = 0
+    rebuilt = var_opt_sketch.deserialize(b, serde)
+    self.assertEqual(serde.calls, 2)
+    self.assertEqual(sorted(vo), sorted(rebuilt))
+
+    # a serde wrongly keeping an array over the data does not fail the deserialize
+    serde = KeepingLongsSerDe()
+    rebuilt = var_opt_sketch.deserialize(b, serde)
+    self.assertEqual(sorted(vo), sorted(rebuilt))
+
+  def test_vo_native_serde_subclass(self):
+    vo = var_opt_sketch(10)
+    for i in range(0, 5):
+      vo.update(str(i), 1.0)
+
+    # the overridden methods are used, not the native implementation
+    serde = PrefixedStringsSerDe()
+    b = vo.serialize(serde)
+    self.assertEqual(vo.get_serialized_size_bytes(serde), len(b))
+    self.assertEqual(len(b), len(vo.serialize(PyStringsSerDe())) + 5)
+    rebuilt = var_opt_sketch.deserialize(b, serde)
+    self.assertEqual(sorted(vo), sorted(rebuilt))
+
 if __name__ == '__main__':
   unittest.main()